@@ -1,50 +1,380 @@
-#include <cstddef>
-#include <map>
-#include <tuple>
-#include <type_traits>
-#include <utility>
-
-template <class F> class memoized_impl {
-  template <class> struct get_sig {};
-
-  template <class T, class R, class S, class... Args>
-  struct get_sig<R (T::*)(S, Args...) const> {
-    using return_type = R;
-    using args = std::tuple<std::decay_t<Args>...>;
-  };
-
-  using signature =
-      get_sig<decltype(&F::template operator()<memoized_impl<F> &>)>;
-  using R = typename signature::return_type;
-  using ArgsTuple = typename signature::args;
-
-  F func;
-  std::map<ArgsTuple, R> memo;
-
-  memoized_impl(const F &func_) : func(func_), memo() {}
-
-  template <std::size_t... I>
-  R apply(const ArgsTuple &args_tuple, std::index_sequence<I...>) {
-    return func(*this, std::get<I>(args_tuple)...);
-  }
-
-public:
-  template <class... Args> R operator()(Args &&... args) {
-    ArgsTuple args_tuple(std::forward<Args>(args)...);
-    const auto itr = memo.find(args_tuple);
-    if (itr != memo.end()) {
-      return itr->second;
-    }
-    R res =
-        apply(args_tuple,
-              std::make_index_sequence<std::tuple_size<ArgsTuple>::value>());
-    memo.emplace(std::move(args_tuple), res);
-    return res;
-  }
-
-  template <class F_> friend auto memoized(const F_ &);
-};
-
-template <class F_> auto memoized(const F_ &func) {
-  return memoized_impl<F_>(func);
-}
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <new>
+#include <optional>
+#include <sys/mman.h>
+#include <tuple>
+#include <type_traits>
+#include <ucontext.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+template <class Tuple> struct tuple_hash {
+  template <std::size_t... I>
+  static std::uint64_t combine(const Tuple &t, std::index_sequence<I...>) {
+    std::uint64_t h = 0;
+    ((h = (h ^ std::hash<std::tuple_element_t<I, Tuple>>()(std::get<I>(t))) *
+          0x9E3779B97F4A7C15),
+     ...);
+    return h;
+  }
+
+  std::uint64_t operator()(const Tuple &t) const {
+    std::uint64_t h =
+        combine(t, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EB;
+    return h ^ (h >> 31);
+  }
+};
+
+template <class Tuple, class = void> struct is_hashable : std::false_type {};
+
+template <class... T>
+struct is_hashable<
+    std::tuple<T...>,
+    std::void_t<decltype(std::hash<T>()(std::declval<const T &>()))...,
+                decltype(std::declval<const T &>() ==
+                         std::declval<const T &>())...>> : std::true_type {};
+
+template <class Key, class Value> class ordered_memo {
+  using map_type = std::map<Key, Value>;
+
+  map_type map;
+
+public:
+  using handle = typename map_type::iterator;
+
+  ordered_memo() : map() {}
+
+  std::pair<handle, bool> lookup(const Key &key) {
+    const handle itr = map.lower_bound(key);
+    return {itr, itr != map.end() && !(key < itr->first)};
+  }
+
+  const Value &get(const handle itr) const { return itr->second; }
+
+  void set(const handle itr, const Key &key, const Value &value) {
+    map.emplace_hint(itr, key, value);
+  }
+};
+
+template <class Key, class Value> class hash_memo {
+  struct slot {
+    std::optional<Key> key;
+    std::optional<Value> value;
+  };
+
+  std::vector<slot> slots;
+  std::size_t count;
+  std::size_t generation;
+
+  std::size_t probe(const Key &key) const {
+    const std::size_t mask = slots.size() - 1;
+    std::size_t i = tuple_hash<Key>()(key) & mask;
+    while (slots[i].key && !(*slots[i].key == key)) {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  void grow() {
+    std::vector<slot> old(slots.size() * 2);
+    std::swap(old, slots);
+    for (slot &s : old) {
+      if (s.key) {
+        slots[probe(*s.key)] = std::move(s);
+      }
+    }
+    generation += 1;
+  }
+
+public:
+  struct handle {
+    std::size_t index;
+    std::size_t generation;
+  };
+
+  hash_memo() : slots(16), count(0), generation(0) {}
+
+  std::pair<handle, bool> lookup(const Key &key) {
+    std::size_t i = probe(key);
+    if (!slots[i].key) {
+      if (4 * (count + 1) > 3 * slots.size()) {
+        grow();
+        i = probe(key);
+      }
+      count += 1;
+      slots[i].key.emplace(key);
+    }
+    return {{i, generation}, slots[i].value.has_value()};
+  }
+
+  const Value &get(const handle h) const { return *slots[h.index].value; }
+
+  void set(const handle h, const Key &key, const Value &value) {
+    slots[h.generation == generation ? h.index : probe(key)].value.emplace(
+        value);
+  }
+};
+
+template <class Key, class Value>
+using default_memo =
+    std::conditional_t<is_hashable<Key>::value, hash_memo<Key, Value>,
+                       ordered_memo<Key, Value>>;
+
+// Argument k must be an integer in [0, bounds[k]).
+template <class Key, class Value> class dense_memo {
+  static constexpr std::size_t N = std::tuple_size<Key>::value;
+
+  std::array<std::size_t, N> bounds;
+  std::vector<Value> values;
+  std::vector<std::uint64_t> done;
+
+  template <std::size_t... I>
+  std::size_t index(const Key &key, std::index_sequence<I...>) const {
+    std::size_t i = 0;
+    ((i = i * bounds[I] + std::size_t(std::get<I>(key))), ...);
+    return i;
+  }
+
+  static std::size_t product(const std::array<std::size_t, N> &bounds) {
+    std::size_t ret = 1;
+    for (const std::size_t b : bounds) {
+      ret *= b;
+    }
+    return ret;
+  }
+
+public:
+  using handle = std::size_t;
+
+  dense_memo(const std::array<std::size_t, N> &bounds_)
+      : bounds(bounds_), values(product(bounds)),
+        done((values.size() + 63) / 64, 0) {}
+
+  std::pair<handle, bool> lookup(const Key &key) const {
+    const std::size_t i = index(key, std::make_index_sequence<N>());
+    return {i, (done[i / 64] >> (i % 64) & 1) != 0};
+  }
+
+  const Value &get(const handle i) const { return values[i]; }
+
+  void set(const handle i, const Key &, const Value &value) {
+    values[i] = value;
+    done[i / 64] |= std::uint64_t(1) << (i % 64);
+  }
+};
+
+class stack_segment {
+  char *map;
+  std::size_t map_bytes;
+
+  static std::size_t page() {
+    return std::size_t(sysconf(_SC_PAGESIZE));
+  }
+
+public:
+  explicit stack_segment(const std::size_t bytes)
+      : map(nullptr), map_bytes((bytes + page() - 1) / page() * page() +
+                                page()) {
+    void *const m = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (m == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    map = static_cast<char *>(m);
+    if (mprotect(map, page(), PROT_NONE) != 0) {
+      munmap(map, map_bytes);
+      throw std::bad_alloc();
+    }
+  }
+
+  stack_segment(stack_segment &&r) noexcept
+      : map(r.map), map_bytes(r.map_bytes) {
+    r.map = nullptr;
+  }
+
+  ~stack_segment() {
+    if (map != nullptr) {
+      munmap(map, map_bytes);
+    }
+  }
+
+  stack_segment(const stack_segment &) = delete;
+  stack_segment &operator=(const stack_segment &) = delete;
+  stack_segment &operator=(stack_segment &&) = delete;
+
+  char *base() const { return map + page(); }
+  std::size_t size() const { return map_bytes - page(); }
+};
+
+inline thread_local std::uintptr_t stack_safe_low = 0;
+
+template <class F, template <class, class> class Table = default_memo,
+          bool Deep = false>
+class memoized_impl {
+  template <class> struct get_sig {};
+
+  template <class T, class R, class S, class... Args>
+  struct get_sig<R (T::*)(S, Args...) const> {
+    using return_type = R;
+    using args = std::tuple<std::decay_t<Args>...>;
+  };
+
+  using signature =
+      get_sig<decltype(&F::template operator()<memoized_impl &>)>;
+  using R = typename signature::return_type;
+  using ArgsTuple = typename signature::args;
+
+  struct segment_call {
+    memoized_impl *self;
+    const ArgsTuple *args_tuple;
+    std::optional<R> res;
+    std::exception_ptr error;
+  };
+
+  static inline thread_local segment_call *entering = nullptr;
+
+  F func;
+  Table<ArgsTuple, R> memo;
+  std::size_t segment_bytes;
+  std::size_t level;
+  std::vector<stack_segment> segments;
+
+  template <class... TableArgs>
+  memoized_impl(const F &func_, TableArgs &&... table_args)
+      : func(func_), memo(std::forward<TableArgs>(table_args)...),
+        segment_bytes(0), level(0), segments() {}
+
+  static std::uintptr_t frame() {
+    return reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0));
+  }
+
+  R apply(const ArgsTuple &args_tuple) {
+    return std::apply(
+        [&](const auto &... args) { return func(*this, args...); },
+        args_tuple);
+  }
+
+  static void enter_segment() {
+    segment_call &call = *entering;
+    try {
+      call.res.emplace(call.self->apply(*call.args_tuple));
+    } catch (...) {
+      call.error = std::current_exception();
+    }
+  }
+
+  R apply_on_segment(const ArgsTuple &args_tuple) {
+    if (level == segments.size()) {
+      segments.emplace_back(segment_bytes);
+    }
+    const stack_segment &segment = segments[level];
+    segment_call call{this, &args_tuple, std::nullopt, nullptr};
+    ucontext_t caller, callee;
+    getcontext(&callee);
+    callee.uc_stack.ss_sp = segment.base();
+    callee.uc_stack.ss_size = segment.size();
+    callee.uc_link = &caller;
+    makecontext(&callee, &enter_segment, 0);
+    const std::uintptr_t saved_low = stack_safe_low;
+    stack_safe_low =
+        reinterpret_cast<std::uintptr_t>(segment.base()) + segment.size() / 4;
+    level += 1;
+    entering = &call;
+    swapcontext(&caller, &callee);
+    level -= 1;
+    stack_safe_low = saved_low;
+    if (call.error) {
+      std::rethrow_exception(call.error);
+    }
+    return std::move(*call.res);
+  }
+
+  R eval(const ArgsTuple &args_tuple) {
+    const auto [entry, found] = memo.lookup(args_tuple);
+    if (found) {
+      return memo.get(entry);
+    }
+    R res = Deep && frame() < stack_safe_low ? apply_on_segment(args_tuple)
+                                             : apply(args_tuple);
+    memo.set(entry, args_tuple, res);
+    return res;
+  }
+
+  R eval_outermost(const ArgsTuple &args_tuple) {
+    stack_safe_low = frame() - segment_bytes / 4 * 3;
+    try {
+      R res = eval(args_tuple);
+      stack_safe_low = 0;
+      return res;
+    } catch (...) {
+      stack_safe_low = 0;
+      throw;
+    }
+  }
+
+public:
+  template <class... Args> R operator()(Args &&... args) {
+    const ArgsTuple args_tuple(std::forward<Args>(args)...);
+    if constexpr (Deep) {
+      if (stack_safe_low == 0) {
+        return eval_outermost(args_tuple);
+      }
+    }
+    return eval(args_tuple);
+  }
+
+  template <class F_> friend auto memoized(const F_ &);
+  template <class F_> friend auto memoized_ordered(const F_ &);
+  template <std::size_t... Bounds, class F_>
+  friend auto memoized_dense(const F_ &);
+  template <class F_, class... Bounds>
+  friend auto memoized_dense(const F_ &, const Bounds...);
+  template <class F_, template <class, class> class Table_>
+  friend auto stack_safe(memoized_impl<F_, Table_> &&, std::size_t);
+};
+
+template <class F_> auto memoized(const F_ &func) {
+  return memoized_impl<F_>(func);
+}
+
+template <class F_> auto memoized_ordered(const F_ &func) {
+  return memoized_impl<F_, ordered_memo>(func);
+}
+
+// Argument k must be in [0, Bounds_k).
+template <std::size_t... Bounds, class F_>
+auto memoized_dense(const F_ &func) {
+  return memoized_impl<F_, dense_memo>(
+      func, std::array<std::size_t, sizeof...(Bounds)>{Bounds...});
+}
+
+template <class F_, class... Bounds>
+auto memoized_dense(const F_ &func, const Bounds... bounds) {
+  return memoized_impl<F_, dense_memo>(
+      func,
+      std::array<std::size_t, sizeof...(Bounds)>{std::size_t(bounds)...});
+}
+
+// A single call of f must fit in a quarter of the smallest segment_bytes
+// of the stack_safe memos it runs under.
+template <class F_, template <class, class> class Table_>
+auto stack_safe(memoized_impl<F_, Table_> &&memo,
+                const std::size_t segment_bytes) {
+  memoized_impl<F_, Table_, true> ret(memo.func, std::move(memo.memo));
+  ret.segment_bytes = std::max<std::size_t>(segment_bytes, 1 << 16);
+  return ret;
+}
+
+template <class F_, template <class, class> class Table_>
+auto stack_safe(memoized_impl<F_, Table_> &&memo) {
+  return stack_safe(std::move(memo), 1 << 20);
+}
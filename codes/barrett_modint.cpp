@@ -0,0 +1,85 @@
+#include <cassert>
+#include <cstdint>
+
+class barrett_modint {
+  using u32 = std::uint32_t;
+  using u64 = std::uint64_t;
+
+  struct context {
+    u32 mod;
+    // ceil(2^64 / mod)
+    u64 im;
+  };
+
+  static thread_local context ctx;
+
+  // z < mod^2 -> z % mod
+  static u32 reduce(const u64 z) {
+    const u64 x = u64((unsigned __int128)z * ctx.im >> 64);
+    u32 ret = u32(z - x * ctx.mod);
+    if (ctx.mod <= ret)
+      ret += ctx.mod;
+    return ret;
+  }
+
+public:
+  class modulus_guard {
+    context prev;
+
+  public:
+    modulus_guard(const u32 m) : prev(ctx) { set_mod(m); }
+    ~modulus_guard() { ctx = prev; }
+    modulus_guard(const modulus_guard &) = delete;
+    modulus_guard &operator=(const modulus_guard &) = delete;
+  };
+
+  // The modulus belongs to the calling thread only.
+  static void set_mod(const u32 m) {
+    assert(1 <= m && m < (u32(1) << 31));
+    ctx = {m, u64(-1) / m + 1};
+  }
+  static u32 mod() { return ctx.mod; }
+
+  u32 v;
+
+  barrett_modint(const u64 x = 0) : v(x % ctx.mod) {}
+  barrett_modint operator+(const barrett_modint rhs) const {
+    return barrett_modint(*this) += rhs;
+  }
+  barrett_modint operator-(const barrett_modint rhs) const {
+    return barrett_modint(*this) -= rhs;
+  }
+  barrett_modint operator*(const barrett_modint rhs) const {
+    return barrett_modint(*this) *= rhs;
+  }
+  barrett_modint operator/(const barrett_modint rhs) const {
+    return barrett_modint(*this) /= rhs;
+  }
+  barrett_modint &operator+=(const barrett_modint rhs) {
+    v += rhs.v;
+    if (v >= ctx.mod)
+      v -= ctx.mod;
+    return *this;
+  }
+  barrett_modint &operator-=(const barrett_modint rhs) {
+    if (v < rhs.v)
+      v += ctx.mod;
+    v -= rhs.v;
+    return *this;
+  }
+  barrett_modint &operator*=(const barrett_modint rhs) {
+    v = reduce(u64(v) * rhs.v);
+    return *this;
+  }
+  barrett_modint &operator/=(barrett_modint rhs) {
+    u64 exp = ctx.mod - 2;
+    while (exp != 0) {
+      if (exp % 2 != 0)
+        *this *= rhs;
+      rhs *= rhs;
+      exp /= 2;
+    }
+    return *this;
+  }
+};
+thread_local barrett_modint::context barrett_modint::ctx = {1, 0};
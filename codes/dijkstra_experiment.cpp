@@ -1,8 +1,21 @@
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
 #include <limits>
+#include <numeric>
 #include <queue>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
 #include <utility>
 #include <vector>
 
@@ -20,6 +33,177 @@ public:
   bool operator<(const edge_type &r) const { return r.cost < cost; }
 };
 
+// A graph is anything with size() and graph[v] iterating over edge_type<T>:
+// vector<vector<edge_type<T>>> or csr_graph<T>.
+template <class Graph>
+using cost_of =
+    std::decay_t<decltype(std::declval<const Graph &>()[0].begin()->cost)>;
+
+// Adjacency lists in one array.
+template <class T> class csr_graph {
+  vector<usize> start;
+  vector<edge_type<T>> edges;
+
+public:
+  class adjacency {
+    const edge_type<T> *first;
+    const edge_type<T> *last;
+
+  public:
+    adjacency(const edge_type<T> *first_, const edge_type<T> *last_)
+        : first(first_), last(last_) {}
+
+    const edge_type<T> *begin() const { return first; }
+    const edge_type<T> *end() const { return last; }
+    usize size() const { return last - first; }
+  };
+
+  // Vertex v of graph becomes map[v], which must be a permutation.
+  template <class Graph>
+  csr_graph(const Graph &graph, const vector<usize> &map)
+      : start(graph.size() + 1, 0), edges() {
+    const usize n = graph.size();
+    for (usize v = 0; v != n; v += 1) {
+      start[map[v] + 1] = graph[v].size();
+    }
+    for (usize v = 0; v != n; v += 1) {
+      start[v + 1] += start[v];
+    }
+    edges.resize(start[n]);
+    for (usize v = 0; v != n; v += 1) {
+      usize i = start[map[v]];
+      for (const auto &e : graph[v]) {
+        edges[i] = {map[e.to], e.cost};
+        i += 1;
+      }
+    }
+  }
+
+  template <class Graph>
+  explicit csr_graph(const Graph &graph)
+      : csr_graph(graph, [&]() {
+          vector<usize> map(graph.size());
+          std::iota(map.begin(), map.end(), usize(0));
+          return map;
+        }()) {}
+
+  usize size() const { return start.size() - 1; }
+
+  adjacency operator[](const usize v) const {
+    return {edges.data() + start[v], edges.data() + start[v + 1]};
+  }
+};
+
+// The reorderings return map with map[v] the new id of v, for csr_graph.
+
+static vector<usize> invert(const vector<usize> &order) {
+  vector<usize> map(order.size());
+  for (usize i = 0; i != order.size(); i += 1) {
+    map[order[i]] = i;
+  }
+  return map;
+}
+
+// BFS order from source along out-edges, then unreached vertices by id.
+template <class Graph>
+vector<usize> bfs_order(const Graph &graph, const usize source) {
+  const usize n = graph.size();
+  vector<usize> order;
+  order.reserve(n);
+  vector<bool> seen(n, false);
+  for (usize r = 0; r != n; r += 1) {
+    const usize root = r == 0 ? source : r == source ? 0 : r;
+    if (seen[root]) {
+      continue;
+    }
+    seen[root] = true;
+    usize j = order.size();
+    order.push_back(root);
+    for (; j != order.size(); j += 1) {
+      for (const auto &e : graph[order[j]]) {
+        if (!seen[e.to]) {
+          seen[e.to] = true;
+          order.push_back(e.to);
+        }
+      }
+    }
+  }
+  return invert(order);
+}
+
+// Reverse Cuthill-McKee with edge directions ignored: BFS from a vertex of
+// minimum degree, neighbors by increasing degree, and the result reversed.
+template <class Graph> vector<usize> rcm_order(const Graph &graph) {
+  const usize n = graph.size();
+  vector<usize> start(n + 1, 0);
+  for (usize v = 0; v != n; v += 1) {
+    for (const auto &e : graph[v]) {
+      start[v + 1] += 1;
+      start[e.to + 1] += 1;
+    }
+  }
+  for (usize v = 0; v != n; v += 1) {
+    start[v + 1] += start[v];
+  }
+  vector<usize> adj(start[n]);
+  {
+    vector<usize> pos(start.begin(), start.end() - 1);
+    for (usize v = 0; v != n; v += 1) {
+      for (const auto &e : graph[v]) {
+        adj[pos[v]++] = e.to;
+        adj[pos[e.to]++] = v;
+      }
+    }
+  }
+  const auto degree = [&](const usize v) { return start[v + 1] - start[v]; };
+  for (usize v = 0; v != n; v += 1) {
+    std::sort(adj.begin() + start[v], adj.begin() + start[v + 1],
+              [&](const usize a, const usize b) {
+                return degree(a) < degree(b);
+              });
+  }
+  vector<usize> by_degree(n);
+  std::iota(by_degree.begin(), by_degree.end(), usize(0));
+  std::stable_sort(by_degree.begin(), by_degree.end(),
+                   [&](const usize a, const usize b) {
+                     return degree(a) < degree(b);
+                   });
+
+  vector<usize> order;
+  order.reserve(n);
+  vector<bool> seen(n, false);
+  for (const usize root : by_degree) {
+    if (seen[root]) {
+      continue;
+    }
+    seen[root] = true;
+    usize j = order.size();
+    order.push_back(root);
+    for (; j != order.size(); j += 1) {
+      const usize v = order[j];
+      for (usize i = start[v]; i != start[v + 1]; i += 1) {
+        if (!seen[adj[i]]) {
+          seen[adj[i]] = true;
+          order.push_back(adj[i]);
+        }
+      }
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return invert(order);
+}
+
+// Decreasing out-degree, so the most visited lists share cache lines.
+template <class Graph> vector<usize> degree_order(const Graph &graph) {
+  vector<usize> order(graph.size());
+  std::iota(order.begin(), order.end(), usize(0));
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const usize a, const usize b) {
+                     return graph[a].size() > graph[b].size();
+                   });
+  return invert(order);
+}
+
 template <class T> class fibonacci_heap {
   class node_type;
   using node_ptr = node_type *;
@@ -196,9 +380,10 @@ public:
   }
 };
 
-template <class T>
-vector<T> dijkstra_fibonacci(const vector<vector<edge_type<T>>> &graph,
-                             const usize source) {
+template <class Graph>
+vector<cost_of<Graph>> dijkstra_fibonacci(const Graph &graph,
+                                          const usize source) {
+  using T = cost_of<Graph>;
   vector<T> ret(graph.size(), inf<T>);
   fibonacci_heap<T> heap(graph.size());
   heap.update_key(source, 0);
@@ -212,9 +397,395 @@ vector<T> dijkstra_fibonacci(const vector<vector<edge_type<T>>> &graph,
   return ret;
 }
 
-template <class T>
-vector<T> dijkstra_binary(const vector<vector<edge_type<T>>> &graph,
-                          const usize source) {
+// fibonacci_heap with 32-bit links, rank and mark in one word and the keys in
+// their own array: 20 bytes of links per vertex instead of 56.
+template <class T> class compact_fibonacci_heap {
+  using u32 = std::uint32_t;
+  static constexpr u32 nil = std::numeric_limits<u32>::max();
+
+  class node_type {
+  public:
+    u32 parent;
+    u32 child;
+    u32 left;
+    u32 right;
+    // rank << 1 | mark
+    u32 rank_mark;
+
+    node_type()
+        : parent(nil), child(nil), left(nil), right(nil), rank_mark(0) {}
+  };
+
+  vector<T> keys;
+  vector<node_type> nodes;
+  u32 root;
+  vector<u32> table;
+
+  void push_root(const u32 v) {
+    if (root == nil) {
+      nodes[v].left = v;
+      nodes[v].right = v;
+      root = v;
+    } else {
+      nodes[v].left = nodes[root].left;
+      nodes[v].right = root;
+      nodes[nodes[root].left].right = v;
+      nodes[root].left = v;
+    }
+  }
+
+public:
+  compact_fibonacci_heap(const usize n)
+      : keys(n, inf<T>), nodes(n), root(nil),
+        table(std::ceil(std::log(n + 1) * 2.08), nil) {}
+
+  bool empty() const { return root == nil; }
+
+  edge_type<T> pop() {
+    edge_type<T> ret = {root, keys[root]};
+
+    usize max = 0;
+    const auto push = [&](u32 v) -> void {
+      while (true) {
+        const u32 rank = nodes[v].rank_mark >> 1;
+        u32 u = table[rank];
+        if (u == nil) {
+          table[rank] = v;
+          break;
+        }
+        table[rank] = nil;
+        if (keys[u] < keys[v]) {
+          std::swap(u, v);
+        }
+        node_type &nu = nodes[u];
+        node_type &nv = nodes[v];
+        const u32 c = nv.child;
+        if (c == nil) {
+          nu.left = u;
+          nu.right = u;
+          nv.child = u;
+        } else {
+          nu.left = nodes[c].left;
+          nu.right = c;
+          nodes[nodes[c].left].right = u;
+          nodes[c].left = u;
+        }
+        nu.parent = v;
+        nv.rank_mark += 2;
+      }
+      max = std::max(max, usize(nodes[v].rank_mark >> 1) + 1);
+    };
+
+    {
+      u32 v = nodes[root].right;
+      while (v != root) {
+        const u32 next = nodes[v].right;
+        push(v);
+        v = next;
+      }
+    }
+    if (nodes[root].child != nil) {
+      u32 v = nodes[root].child;
+      do {
+        const u32 next = nodes[v].right;
+        nodes[v].rank_mark &= ~u32(1);
+        push(v);
+        v = next;
+      } while (v != nodes[root].child);
+    }
+    root = nil;
+
+    for (usize i = 0; i != max; i += 1) {
+      const u32 v = table[i];
+      if (v == nil) {
+        continue;
+      }
+      table[i] = nil;
+      nodes[v].parent = nil;
+      push_root(v);
+      if (keys[root] > keys[v]) {
+        root = v;
+      }
+    }
+
+    return ret;
+  }
+
+  void update_key(const usize v_, const T key) {
+    u32 v = v_;
+
+    if (keys[v] <= key) {
+      return;
+    }
+    keys[v] = key;
+
+    if (nodes[v].left == nil) {
+      push_root(v);
+      if (key < keys[root]) {
+        root = v;
+      }
+      return;
+    }
+
+    if (nodes[v].parent == nil) {
+      if (key < keys[root]) {
+        root = v;
+      }
+      return;
+    } else {
+      if (keys[nodes[v].parent] <= key) {
+        return;
+      }
+    }
+
+    while (true) {
+      node_type &nv = nodes[v];
+      const u32 p = nv.parent;
+      nodes[nv.left].right = nv.right;
+      nodes[nv.right].left = nv.left;
+      nv.parent = nil;
+      nodes[p].rank_mark -= 2;
+      if (nodes[p].child == v) {
+        if ((nodes[p].rank_mark >> 1) == 0) {
+          nodes[p].child = nil;
+        } else {
+          nodes[p].child = nv.right;
+        }
+      }
+
+      push_root(v);
+      nv.rank_mark &= ~u32(1);
+
+      v = p;
+      if (nodes[v].parent == nil) {
+        break;
+      }
+      if ((nodes[v].rank_mark & 1) == 0) {
+        nodes[v].rank_mark |= 1;
+        break;
+      }
+    }
+    if (keys[root] > key) {
+      root = v_;
+    }
+  }
+};
+
+// Index-based pairing heap with two-pass pop.
+template <class T> class pairing_heap {
+  using u32 = std::uint32_t;
+  static constexpr u32 nil = std::numeric_limits<u32>::max();
+
+  class node_type {
+  public:
+    u32 child;
+    u32 next;
+    // previous sibling, or the parent for a first child
+    u32 prev;
+
+    node_type() : child(nil), next(nil), prev(nil) {}
+  };
+
+  vector<T> keys;
+  vector<node_type> nodes;
+  u32 root;
+  vector<u32> pairs;
+
+  u32 meld(u32 a, u32 b) {
+    if (keys[b] < keys[a]) {
+      std::swap(a, b);
+    }
+    const u32 c = nodes[a].child;
+    nodes[b].next = c;
+    if (c != nil) {
+      nodes[c].prev = b;
+    }
+    nodes[b].prev = a;
+    nodes[a].child = b;
+    return a;
+  }
+
+public:
+  pairing_heap(const usize n) : keys(n, inf<T>), nodes(n), root(nil), pairs() {}
+
+  bool empty() const { return root == nil; }
+
+  edge_type<T> pop() {
+    edge_type<T> ret = {root, keys[root]};
+
+    pairs.clear();
+    u32 v = nodes[root].child;
+    while (v != nil) {
+      const u32 w = nodes[v].next;
+      nodes[v].prev = nil;
+      nodes[v].next = nil;
+      if (w == nil) {
+        pairs.push_back(v);
+        break;
+      }
+      const u32 next = nodes[w].next;
+      nodes[w].prev = nil;
+      nodes[w].next = nil;
+      pairs.push_back(meld(v, w));
+      v = next;
+    }
+    nodes[root].child = nil;
+    root = nil;
+    while (!pairs.empty()) {
+      root = root == nil ? pairs.back() : meld(pairs.back(), root);
+      pairs.pop_back();
+    }
+
+    return ret;
+  }
+
+  void update_key(const usize v_, const T key) {
+    const u32 v = v_;
+
+    if (keys[v] <= key) {
+      return;
+    }
+    const bool fresh = keys[v] == inf<T>;
+    keys[v] = key;
+
+    if (v == root) {
+      return;
+    }
+    if (!fresh) {
+      node_type &nv = nodes[v];
+      if (nodes[nv.prev].child == v) {
+        nodes[nv.prev].child = nv.next;
+      } else {
+        nodes[nv.prev].next = nv.next;
+      }
+      if (nv.next != nil) {
+        nodes[nv.next].prev = nv.prev;
+      }
+      nv.next = nil;
+      nv.prev = nil;
+    }
+    root = root == nil ? v : meld(root, v);
+  }
+};
+
+// Indexed D-ary heap. Entries carry a copy of their key so sifting stays
+// within the heap array.
+template <class T, usize D = 4> class dary_heap {
+  using u32 = std::uint32_t;
+  static constexpr u32 nil = std::numeric_limits<u32>::max();
+
+  class entry {
+  public:
+    T key;
+    u32 v;
+  };
+
+  vector<T> keys;
+  vector<u32> pos;
+  vector<entry> heap;
+
+  void place(const usize i, const entry e) {
+    heap[i] = e;
+    pos[e.v] = i;
+  }
+
+  void sift_up(usize i) {
+    const entry e = heap[i];
+    while (i != 0) {
+      const usize p = (i - 1) / D;
+      if (heap[p].key <= e.key) {
+        break;
+      }
+      place(i, heap[p]);
+      i = p;
+    }
+    place(i, e);
+  }
+
+  void sift_down(usize i) {
+    const entry e = heap[i];
+    const usize n = heap.size();
+    while (true) {
+      const usize c = i * D + 1;
+      if (c >= n) {
+        break;
+      }
+      usize best = c;
+      for (usize j = c + 1; j < std::min(c + D, n); j += 1) {
+        if (heap[j].key < heap[best].key) {
+          best = j;
+        }
+      }
+      if (e.key <= heap[best].key) {
+        break;
+      }
+      place(i, heap[best]);
+      i = best;
+    }
+    place(i, e);
+  }
+
+public:
+  dary_heap(const usize n) : keys(n, inf<T>), pos(n, nil), heap() {}
+
+  bool empty() const { return heap.empty(); }
+
+  edge_type<T> pop() {
+    const entry top = heap[0];
+    pos[top.v] = nil;
+    const entry last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+      heap[0] = last;
+      sift_down(0);
+    }
+    return {top.v, top.key};
+  }
+
+  void update_key(const usize v, const T key) {
+    if (keys[v] <= key) {
+      return;
+    }
+    keys[v] = key;
+    if (pos[v] == nil) {
+      pos[v] = heap.size();
+      heap.push_back({key, u32(v)});
+    } else {
+      heap[pos[v]].key = key;
+    }
+    sift_up(pos[v]);
+  }
+};
+
+// Heap is used like fibonacci_heap: update_key ignores keys that are not
+// smaller, so settled vertices are never pushed again. heap must be empty and
+// sized for graph.
+template <class Heap, class Graph>
+vector<cost_of<Graph>> dijkstra_decrease_key(const Graph &graph,
+                                             const usize source, Heap &heap) {
+  using T = cost_of<Graph>;
+  vector<T> ret(graph.size(), inf<T>);
+  heap.update_key(source, 0);
+  while (!heap.empty()) {
+    const auto top = heap.pop();
+    ret[top.to] = top.cost;
+    for (const auto &edge : graph[top.to]) {
+      heap.update_key(edge.to, top.cost + edge.cost);
+    }
+  }
+  return ret;
+}
+
+template <class Heap, class Graph>
+vector<cost_of<Graph>> dijkstra_decrease_key(const Graph &graph,
+                                             const usize source) {
+  Heap heap(graph.size());
+  return dijkstra_decrease_key(graph, source, heap);
+}
+
+template <class Graph>
+vector<cost_of<Graph>> dijkstra_binary(const Graph &graph, const usize source) {
+  using T = cost_of<Graph>;
   vector<T> ret(graph.size(), inf<T>);
   std::priority_queue<edge_type<T>> que;
   const auto push = [&](const usize v, const T c) -> void {
@@ -239,118 +810,1433 @@ vector<T> dijkstra_binary(const vector<vector<edge_type<T>>> &graph,
   return ret;
 }
 
-template <class T>
-vector<T> dijkstra_naive(const vector<vector<edge_type<T>>> &graph,
-                         const usize source) {
-  const usize n = graph.size();
-  vector<T> dist(n, inf<T>);
-  vector<bool> visited(n, false);
-  dist[source] = 0;
-  while (true) {
-    usize mindex = n;
-    for (usize i = 0; i != n; i += 1) {
-      if (!visited[i] && (mindex == n || dist[mindex] > dist[i])) {
-        mindex = i;
-      }
-    }
-    if (mindex == n) {
-      break;
-    }
-    visited[mindex] = true;
-    for (const auto &e : graph[mindex]) {
-      dist[e.to] = std::min(dist[e.to], dist[mindex] + e.cost);
-    }
+// Monotone: every pushed key must be at least the last popped key.
+template <class T> class radix_heap {
+  static_assert(std::is_unsigned_v<T> && sizeof(T) <= sizeof(u64));
+
+  // buckets[i] holds keys whose highest bit differing from last is i - 1.
+  vector<edge_type<T>> buckets[65];
+  T last;
+  usize size;
+
+  static usize bucket(const T key, const T last) {
+    return key == last ? 0 : 64 - __builtin_clzll(u64(key ^ last));
   }
 
-  return dist;
-}
+public:
+  radix_heap() : buckets(), last(0), size(0) {}
 
-#include <algorithm>
-#include <cassert>
-#include <chrono>
-#include <iostream>
-#include <numeric>
-#include <random>
+  bool empty() const { return size == 0; }
 
-template <class T> struct edge_info {
+  void push(const usize v, const T key) {
+    size += 1;
+    buckets[bucket(key, last)].push_back({v, key});
+  }
+
+  edge_type<T> pop() {
+    if (buckets[0].empty()) {
+      usize i = 1;
+      while (buckets[i].empty()) {
+        i += 1;
+      }
+      last = buckets[i][0].cost;
+      for (const auto &e : buckets[i]) {
+        last = std::min(last, e.cost);
+      }
+      for (const auto &e : buckets[i]) {
+        buckets[bucket(e.cost, last)].push_back(e);
+      }
+      buckets[i].clear();
+    }
+    size -= 1;
+    const edge_type<T> ret = buckets[0].back();
+    buckets[0].pop_back();
+    return ret;
+  }
+};
+
+template <class Graph>
+vector<cost_of<Graph>> dijkstra_radix(const Graph &graph, const usize source) {
+  using T = cost_of<Graph>;
+  vector<T> ret(graph.size(), inf<T>);
+  radix_heap<T> heap;
+  const auto push = [&](const usize v, const T c) -> void {
+    if (ret[v] > c) {
+      ret[v] = c;
+      heap.push(v, c);
+    }
+  };
+  push(source, 0);
+  while (!heap.empty()) {
+    const auto [v, c] = heap.pop();
+    if (ret[v] < c) {
+      continue;
+    }
+    for (const auto &e : graph[v]) {
+      push(e.to, c + e.cost);
+    }
+  }
+
+  return ret;
+}
+
+// Dial's algorithm: max_cost + 1 buckets used circularly, so it is only
+// practical when every edge cost is small.
+template <class Graph>
+vector<cost_of<Graph>> dijkstra_dial(const Graph &graph, const usize source) {
+  using T = cost_of<Graph>;
+  static_assert(std::is_integral_v<T>);
+  T max_cost = 0;
+  for (usize v = 0; v != graph.size(); v += 1) {
+    for (const auto &e : graph[v]) {
+      max_cost = std::max(max_cost, e.cost);
+    }
+  }
+  const usize width = usize(max_cost) + 1;
+
+  vector<T> ret(graph.size(), inf<T>);
+  vector<vector<usize>> buckets(width);
+  usize pending = 0;
+  const auto push = [&](const usize v, const T c) -> void {
+    if (ret[v] > c) {
+      ret[v] = c;
+      buckets[c % width].push_back(v);
+      pending += 1;
+    }
+  };
+  push(source, 0);
+  for (T c = 0; pending != 0; c += 1) {
+    vector<usize> &bucket = buckets[c % width];
+    while (!bucket.empty()) {
+      const usize v = bucket.back();
+      bucket.pop_back();
+      pending -= 1;
+      if (ret[v] != c) {
+        continue;
+      }
+      for (const auto &e : graph[v]) {
+        push(e.to, c + e.cost);
+      }
+    }
+  }
+
+  return ret;
+}
+
+class spin_barrier {
+  const usize count;
+  std::atomic<usize> waiting;
+  std::atomic<usize> phase;
+
+public:
+  spin_barrier(const usize count_) : count(count_), waiting(0), phase(0) {}
+
+  void arrive_and_wait() {
+    const usize p = phase.load(std::memory_order_acquire);
+    if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+      waiting.store(0, std::memory_order_relaxed);
+      phase.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    while (phase.load(std::memory_order_acquire) == p) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+// Parallel delta-stepping. Bucket b holds tentative distances in
+// [b * delta, (b + 1) * delta). The threads share the current bucket through
+// an atomic cursor, relax edges with an atomic minimum and push improved
+// vertices to buckets of their own. A bucket is repeated until it stays
+// empty, then the smallest non-empty bucket of any thread is next.
+// delta == 0 picks max cost / average out-degree. Each thread keeps
+// max distance / delta buckets, so delta must not be tiny.
+template <class Graph>
+vector<cost_of<Graph>> delta_stepping(const Graph &graph, const usize source,
+                                      cost_of<Graph> delta,
+                                      const usize threads) {
+  using T = cost_of<Graph>;
+  const usize n = graph.size();
+  if (delta == 0) {
+    T max_cost = 0;
+    usize m = 0;
+    for (usize v = 0; v != n; v += 1) {
+      for (const auto &e : graph[v]) {
+        max_cost = std::max(max_cost, e.cost);
+        m += 1;
+      }
+    }
+    delta = std::max(T(1), T(max_cost / std::max<usize>(1, m / n)));
+  }
+
+  vector<std::atomic<T>> dist(n);
+  for (auto &d : dist) {
+    d.store(inf<T>, std::memory_order_relaxed);
+  }
+  dist[source].store(0, std::memory_order_relaxed);
+
+  static constexpr usize chunk = 64;
+  static constexpr usize none = std::numeric_limits<usize>::max();
+  vector<usize> frontier = {source};
+  std::atomic<usize> cursor(0);
+  usize bucket = 0;
+  vector<usize> mins(threads), sizes(threads);
+  spin_barrier barrier(threads);
+
+  const auto work = [&](const usize t) {
+    vector<vector<usize>> bins;
+    while (true) {
+      while (true) {
+        const usize begin = cursor.fetch_add(chunk, std::memory_order_relaxed);
+        if (begin >= frontier.size()) {
+          break;
+        }
+        const usize end = std::min(begin + chunk, frontier.size());
+        for (usize i = begin; i != end; i += 1) {
+          const usize v = frontier[i];
+          const T d = dist[v].load(std::memory_order_relaxed);
+          if (d / delta != bucket) {
+            continue;
+          }
+          for (const auto &e : graph[v]) {
+            const T nd = d + e.cost;
+            T cur = dist[e.to].load(std::memory_order_relaxed);
+            while (nd < cur) {
+              if (dist[e.to].compare_exchange_weak(
+                      cur, nd, std::memory_order_relaxed)) {
+                const usize b = nd / delta;
+                if (bins.size() <= b) {
+                  bins.resize(b + 1);
+                }
+                bins[b].push_back(e.to);
+                break;
+              }
+            }
+          }
+        }
+      }
+      barrier.arrive_and_wait();
+
+      mins[t] = none;
+      for (usize b = bucket; b < bins.size(); b += 1) {
+        if (!bins[b].empty()) {
+          mins[t] = b;
+          break;
+        }
+      }
+      barrier.arrive_and_wait();
+
+      const usize next = *std::min_element(mins.begin(), mins.end());
+      if (next == none) {
+        break;
+      }
+      sizes[t] = next < bins.size() ? bins[next].size() : 0;
+      barrier.arrive_and_wait();
+
+      if (t == 0) {
+        frontier.resize(std::accumulate(sizes.begin(), sizes.end(), usize(0)));
+        cursor.store(0, std::memory_order_relaxed);
+        bucket = next;
+      }
+      barrier.arrive_and_wait();
+
+      if (sizes[t] != 0) {
+        const usize offset =
+            std::accumulate(sizes.begin(), sizes.begin() + t, usize(0));
+        std::copy(bins[next].begin(), bins[next].end(),
+                  frontier.begin() + offset);
+        bins[next].clear();
+      }
+      barrier.arrive_and_wait();
+    }
+  };
+
+  vector<std::thread> workers;
+  for (usize t = 1; t < threads; t += 1) {
+    workers.emplace_back(work, t);
+  }
+  work(0);
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  vector<T> ret(n);
+  for (usize v = 0; v != n; v += 1) {
+    ret[v] = dist[v].load(std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+// Distances and a heap for one search. The buffers live across searches and
+// only the vertices touched by the last one are reset, so a search costs
+// nothing for the part of the graph it does not reach.
+template <class T> class sparse_search {
+public:
+  vector<T> dist;
+  vector<usize> touched;
+  vector<edge_type<T>> heap;
+
+  sparse_search(const usize n) : dist(n, inf<T>), touched(), heap() {}
+
+  void clear() {
+    for (const usize v : touched) {
+      dist[v] = inf<T>;
+    }
+    touched.clear();
+    heap.clear();
+  }
+
+  // key is the heap priority, dist[v] = d.
+  bool push(const usize v, const T d, const T key) {
+    if (dist[v] <= d) {
+      return false;
+    }
+    if (dist[v] == inf<T>) {
+      touched.push_back(v);
+    }
+    dist[v] = d;
+    heap.push_back({v, key});
+    std::push_heap(heap.begin(), heap.end());
+    return true;
+  }
+
+  edge_type<T> pop() {
+    std::pop_heap(heap.begin(), heap.end());
+    const edge_type<T> ret = heap.back();
+    heap.pop_back();
+    return ret;
+  }
+};
+
+// Contraction hierarchy. Vertices are contracted one by one in order of
+// edge difference (shortcuts added minus edges removed) plus the number of
+// contracted neighbors, reevaluated lazily when a vertex reaches the front.
+// up(v) holds the edges from v to vertices contracted after it, and down(v)
+// the edges into v from them, reversed, so a query is two upward searches.
+//
+// The index is a single buffer of 64-bit words:
+//   magic, n, up edge count, down edge count,
+//   up start[n + 1], down start[n + 1], up edges, down edges,
+// which save writes as is and the path constructor maps after checking it.
+template <class T> class contraction_hierarchy {
+  static_assert(std::is_trivially_copyable_v<edge_type<T>> &&
+                alignof(edge_type<T>) <= alignof(u64) &&
+                sizeof(edge_type<T>) % sizeof(u64) == 0);
+
+  static constexpr u64 magic = 0x3176786568637263; // "crchexv1"
+  static constexpr usize header = 4;
+  static constexpr usize edge_words = sizeof(edge_type<T>) / sizeof(u64);
+  // A witness search gives up after this many relaxations and the shortcut
+  // is added anyway, which only costs space.
+  static constexpr usize witness_limit = 1000;
+
+  vector<u64> buf;
+  void *map;
+  usize map_size;
+  const u64 *words;
+  usize word_count;
+
+  void attach(const u64 *const words_, const usize word_count_) {
+    words = words_;
+    word_count = word_count_;
+  }
+
+  static void add_min(vector<edge_type<T>> &list, const usize to,
+                      const T cost) {
+    for (auto &e : list) {
+      if (e.to == to) {
+        e.cost = std::min(e.cost, cost);
+        return;
+      }
+    }
+    list.push_back({to, cost});
+  }
+
+  static void erase(vector<edge_type<T>> &list, const usize to) {
+    for (auto &e : list) {
+      if (e.to == to) {
+        e = list.back();
+        list.pop_back();
+        return;
+      }
+    }
+  }
+
+  const u64 *start(const usize i) const { return words + header + i; }
+
+  // Whether the count words at w are an index that queries can follow: the
+  // counts fit the size, both start arrays are nondecreasing from 0 to their
+  // edge counts, and every edge leads to a vertex.
+  static bool well_formed(const u64 *const w, const usize count) {
+    if (count < header || w[0] != magic || w[1] >= count / 2 ||
+        count < header + 2 * (w[1] + 1)) {
+      return false;
+    }
+    const usize n = w[1];
+    const usize rest = (count - header - 2 * (n + 1)) / edge_words;
+    if (w[2] > rest || w[3] != rest - w[2] ||
+        count != header + 2 * (n + 1) + rest * edge_words) {
+      return false;
+    }
+    for (usize k = 0; k != 2; k += 1) {
+      const u64 *const s = w + header + k * (n + 1);
+      if (s[0] != 0 || s[n] != w[2 + k]) {
+        return false;
+      }
+      for (usize v = 0; v != n; v += 1) {
+        if (s[v] > s[v + 1]) {
+          return false;
+        }
+      }
+    }
+    const edge_type<T> *const e =
+        reinterpret_cast<const edge_type<T> *>(w + header + 2 * (n + 1));
+    for (usize i = 0; i != rest; i += 1) {
+      if (e[i].to >= n) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  [[noreturn]] static void fail(const char *const path,
+                                const char *const what) {
+    throw std::runtime_error(std::string(path) + ": " + what);
+  }
+
+  const edge_type<T> *edges(const usize i) const {
+    return reinterpret_cast<const edge_type<T> *>(words + header +
+                                                  2 * (size() + 1)) +
+           i;
+  }
+
+public:
+  using adjacency = typename csr_graph<T>::adjacency;
+
+  template <class Graph>
+  explicit contraction_hierarchy(const Graph &graph)
+      : buf(), map(nullptr), map_size(0), words(nullptr), word_count(0) {
+    const usize n = graph.size();
+    vector<vector<edge_type<T>>> out(n), in(n);
+    for (usize v = 0; v != n; v += 1) {
+      for (const auto &e : graph[v]) {
+        if (e.to != v) {
+          out[v].push_back({e.to, e.cost});
+        }
+      }
+      // Parallel edges collapse to the cheapest.
+      std::sort(out[v].begin(), out[v].end(), [](const auto &l, const auto &r) {
+        return l.to != r.to ? l.to < r.to : l.cost < r.cost;
+      });
+      out[v].erase(std::unique(out[v].begin(), out[v].end(),
+                               [](const auto &l, const auto &r) {
+                                 return l.to == r.to;
+                               }),
+                   out[v].end());
+      for (const auto &e : out[v]) {
+        in[e.to].push_back({v, e.cost});
+      }
+    }
+
+    class shortcut {
+    public:
+      usize from;
+      usize to;
+      T cost;
+    };
+    sparse_search<T> witness(n);
+    vector<shortcut> shortcuts;
+    vector<bool> target(n, false);
+    // Shortcuts needed to contract v, each in-neighbor u searching for
+    // paths that avoid v and are no longer than the ones through it.
+    const auto find_shortcuts = [&](const usize v) {
+      shortcuts.clear();
+      T max_out = 0;
+      for (const auto &e : out[v]) {
+        max_out = std::max(max_out, e.cost);
+        target[e.to] = true;
+      }
+      for (const auto &[u, cu] : in[v]) {
+        const T limit = cu + max_out;
+        witness.clear();
+        witness.push(u, 0, 0);
+        usize relaxed = 0;
+        usize remaining = out[v].size();
+        while (!witness.heap.empty() && relaxed < witness_limit) {
+          const auto [x, c] = witness.pop();
+          if (witness.dist[x] < c) {
+            continue;
+          }
+          if (c > limit) {
+            break;
+          }
+          if (target[x]) {
+            remaining -= 1;
+            if (remaining == 0) {
+              break;
+            }
+          }
+          for (const auto &e : out[x]) {
+            if (e.to != v) {
+              witness.push(e.to, c + e.cost, c + e.cost);
+              relaxed += 1;
+            }
+          }
+        }
+        for (const auto &[w, cw] : out[v]) {
+          if (w != u && witness.dist[w] > cu + cw) {
+            shortcuts.push_back({u, w, cu + cw});
+          }
+        }
+      }
+      for (const auto &e : out[v]) {
+        target[e.to] = false;
+      }
+    };
+
+    using i64 = std::int64_t;
+    vector<i64> contracted_neighbors(n, 0);
+    const auto priority = [&](const usize v, const usize added) -> i64 {
+      return i64(added) - i64(in[v].size()) - i64(out[v].size()) +
+             contracted_neighbors[v];
+    };
+    using entry = std::pair<i64, usize>;
+    std::priority_queue<entry, vector<entry>, std::greater<entry>> queue;
+    for (usize v = 0; v != n; v += 1) {
+      // Searching from every in-neighbor of every vertex up front is too
+      // slow around high-degree vertices, so the first key counts every
+      // pair as a shortcut.
+      queue.push({priority(v, in[v].size() * out[v].size()), v});
+    }
+    vector<vector<edge_type<T>>> up(n), down(n);
+    while (!queue.empty()) {
+      const usize v = queue.top().second;
+      queue.pop();
+      find_shortcuts(v);
+      const i64 p = priority(v, shortcuts.size());
+      if (!queue.empty() && p > queue.top().first) {
+        queue.push({p, v});
+        continue;
+      }
+      up[v] = std::move(out[v]);
+      down[v] = std::move(in[v]);
+      out[v].clear();
+      in[v].clear();
+      for (const auto &e : up[v]) {
+        erase(in[e.to], v);
+        contracted_neighbors[e.to] += 1;
+      }
+      for (const auto &e : down[v]) {
+        erase(out[e.to], v);
+        contracted_neighbors[e.to] += 1;
+      }
+      for (const auto &s : shortcuts) {
+        add_min(out[s.from], s.to, s.cost);
+        add_min(in[s.to], s.from, s.cost);
+      }
+    }
+
+    usize up_count = 0;
+    usize down_count = 0;
+    for (usize v = 0; v != n; v += 1) {
+      up_count += up[v].size();
+      down_count += down[v].size();
+    }
+    buf.assign(header + 2 * (n + 1) + (up_count + down_count) * edge_words,
+               0);
+    buf[0] = magic;
+    buf[1] = n;
+    buf[2] = up_count;
+    buf[3] = down_count;
+    u64 *const up_start = buf.data() + header;
+    u64 *const down_start = up_start + n + 1;
+    for (usize v = 0; v != n; v += 1) {
+      up_start[v + 1] = up_start[v] + up[v].size();
+      down_start[v + 1] = down_start[v] + down[v].size();
+    }
+    attach(buf.data(), buf.size());
+    edge_type<T> *const up_edges = const_cast<edge_type<T> *>(edges(0));
+    edge_type<T> *const down_edges = up_edges + up_count;
+    for (usize v = 0; v != n; v += 1) {
+      std::copy(up[v].begin(), up[v].end(), up_edges + up_start[v]);
+      std::copy(down[v].begin(), down[v].end(), down_edges + down_start[v]);
+    }
+  }
+
+  // Maps a file written by save. Throws std::runtime_error if the file
+  // cannot be mapped or is not a well-formed index, which reads every page
+  // once.
+  explicit contraction_hierarchy(const char *const path)
+      : buf(), map(nullptr), map_size(0), words(nullptr), word_count(0) {
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      fail(path, "cannot open");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        usize(st.st_size) < sizeof(u64) * header ||
+        usize(st.st_size) % sizeof(u64) != 0) {
+      ::close(fd);
+      fail(path, "not a contraction hierarchy index");
+    }
+    void *const m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+      fail(path, "cannot map");
+    }
+    const usize count = usize(st.st_size) / sizeof(u64);
+    if (!well_formed(static_cast<const u64 *>(m), count)) {
+      munmap(m, st.st_size);
+      fail(path, "not a contraction hierarchy index");
+    }
+    map = m;
+    map_size = st.st_size;
+    attach(static_cast<const u64 *>(m), count);
+  }
+
+  contraction_hierarchy(contraction_hierarchy &&r) noexcept
+      : buf(std::move(r.buf)), map(r.map), map_size(r.map_size),
+        words(r.words), word_count(r.word_count) {
+    r.map = nullptr;
+  }
+
+  ~contraction_hierarchy() {
+    if (map != nullptr) {
+      munmap(map, map_size);
+    }
+  }
+
+  contraction_hierarchy(const contraction_hierarchy &) = delete;
+  contraction_hierarchy &operator=(const contraction_hierarchy &) = delete;
+  contraction_hierarchy &operator=(contraction_hierarchy &&) = delete;
+
+  bool save(const char *const path) const {
+    std::FILE *const f = std::fopen(path, "wb");
+    if (f == nullptr) {
+      return false;
+    }
+    const bool ok =
+        std::fwrite(words, sizeof(u64), word_count, f) == word_count;
+    return std::fclose(f) == 0 && ok;
+  }
+
+  usize size() const { return words[1]; }
+  usize edge_count() const { return words[2] + words[3]; }
+  usize bytes() const { return word_count * sizeof(u64); }
+
+  adjacency up(const usize v) const {
+    return {edges(*start(v)), edges(*start(v + 1))};
+  }
+  adjacency down(const usize v) const {
+    const usize offset = words[2];
+    return {edges(offset + *start(size() + 1 + v)),
+            edges(offset + *start(size() + 2 + v))};
+  }
+};
+
+// Point-to-point queries, reusing their buffers across calls.
+template <class T> class point_to_point {
+  sparse_search<T> forward;
+  sparse_search<T> backward;
+
+public:
+  point_to_point(const usize n) : forward(n), backward(n) {}
+
+  // Stops as soon as t is settled.
+  template <class Graph>
+  T to(const Graph &graph, const usize s, const usize t) {
+    forward.clear();
+    forward.push(s, 0, 0);
+    while (!forward.heap.empty()) {
+      const auto [v, c] = forward.pop();
+      if (forward.dist[v] < c) {
+        continue;
+      }
+      if (v == t) {
+        return c;
+      }
+      for (const auto &e : graph[v]) {
+        forward.push(e.to, c + e.cost, c + e.cost);
+      }
+    }
+    return inf<T>;
+  }
+
+  // reverse has an edge v -> u of the same cost for every edge u -> v.
+  // Grows the side with the smaller heap and stops once the two smallest
+  // keys together reach the best path seen.
+  template <class Graph>
+  T bidirectional(const Graph &graph, const Graph &reverse, const usize s,
+                  const usize t) {
+    forward.clear();
+    backward.clear();
+    forward.push(s, 0, 0);
+    backward.push(t, 0, 0);
+    T best = s == t ? 0 : inf<T>;
+    while (!forward.heap.empty() && !backward.heap.empty()) {
+      if (forward.heap[0].cost >= best ||
+          backward.heap[0].cost >= best - forward.heap[0].cost) {
+        break;
+      }
+      const bool fwd = forward.heap.size() <= backward.heap.size();
+      sparse_search<T> &a = fwd ? forward : backward;
+      sparse_search<T> &b = fwd ? backward : forward;
+      const auto [v, c] = a.pop();
+      if (a.dist[v] < c) {
+        continue;
+      }
+      for (const auto &e : (fwd ? graph : reverse)[v]) {
+        const T d = c + e.cost;
+        if (a.push(e.to, d, d) && b.dist[e.to] != inf<T>) {
+          best = std::min(best, d + b.dist[e.to]);
+        }
+      }
+    }
+    return best;
+  }
+
+  // potential(v) must be a consistent lower bound of the distance from v to
+  // t: potential(u) <= cost(u, v) + potential(v) and potential(t) == 0.
+  template <class Graph, class Potential>
+  T astar(const Graph &graph, const usize s, const usize t,
+          Potential potential) {
+    forward.clear();
+    forward.push(s, 0, potential(s));
+    while (!forward.heap.empty()) {
+      const auto [v, key] = forward.pop();
+      const T c = forward.dist[v];
+      if (c + potential(v) < key) {
+        continue;
+      }
+      if (v == t) {
+        return c;
+      }
+      for (const auto &e : graph[v]) {
+        const T d = c + e.cost;
+        if (forward.dist[e.to] > d) {
+          forward.push(e.to, d, d + potential(e.to));
+        }
+      }
+    }
+    return inf<T>;
+  }
+  // Upward searches from s and t in a contraction hierarchy. A shortest path
+  // climbs from s and descends to t, so both searches reach its highest
+  // vertex, and a side stops once its smallest key reaches the best path.
+  T hierarchy(const contraction_hierarchy<T> &ch, const usize s,
+              const usize t) {
+    forward.clear();
+    backward.clear();
+    forward.push(s, 0, 0);
+    backward.push(t, 0, 0);
+    T best = inf<T>;
+    bool fwd = false;
+    while (true) {
+      const bool f = !forward.heap.empty() && forward.heap[0].cost < best;
+      const bool b = !backward.heap.empty() && backward.heap[0].cost < best;
+      if (!f && !b) {
+        break;
+      }
+      fwd = f && (!b || !fwd);
+      sparse_search<T> &a = fwd ? forward : backward;
+      const sparse_search<T> &other = fwd ? backward : forward;
+      const auto [v, c] = a.pop();
+      if (a.dist[v] < c) {
+        continue;
+      }
+      if (other.dist[v] != inf<T>) {
+        best = std::min(best, c + other.dist[v]);
+      }
+      for (const auto &e : fwd ? ch.up(v) : ch.down(v)) {
+        a.push(e.to, c + e.cost, c + e.cost);
+      }
+    }
+    return best;
+  }
+};
+
+template <class Graph>
+cost_of<Graph> dijkstra_to(const Graph &graph, const usize s, const usize t) {
+  return point_to_point<cost_of<Graph>>(graph.size()).to(graph, s, t);
+}
+
+template <class Graph>
+vector<vector<edge_type<cost_of<Graph>>>> reverse_graph(const Graph &graph) {
+  vector<vector<edge_type<cost_of<Graph>>>> ret(graph.size());
+  for (usize v = 0; v != graph.size(); v += 1) {
+    for (const auto &e : graph[v]) {
+      ret[e.to].push_back({v, e.cost});
+    }
+  }
+  return ret;
+}
+
+template <class Graph>
+vector<cost_of<Graph>> dijkstra_naive(const Graph &graph, const usize source) {
+  using T = cost_of<Graph>;
+  const usize n = graph.size();
+  vector<T> dist(n, inf<T>);
+  vector<bool> visited(n, false);
+  dist[source] = 0;
+  while (true) {
+    usize mindex = n;
+    for (usize i = 0; i != n; i += 1) {
+      if (!visited[i] && (mindex == n || dist[mindex] > dist[i])) {
+        mindex = i;
+      }
+    }
+    if (mindex == n || dist[mindex] == inf<T>) {
+      break;
+    }
+    visited[mindex] = true;
+    for (const auto &e : graph[mindex]) {
+      dist[e.to] = std::min(dist[e.to], dist[mindex] + e.cost);
+    }
+  }
+
+  return dist;
+}
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <numeric>
+#include <random>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+// Usage: dijkstra_experiment [families=adversarial,random,grid,powerlaw]
+//          [sizes=N,NxD,...] [degree=D] [cost=C]
+//          [algorithms=fibonacci,binary,...] [layouts=list,csr,bfs,rcm,degree]
+//          [runs=R] [warmup=W] [threads=T] [perf=0|1] [format=json|csv]
+//          [seed=S]
+// Every (family, size, layout, algorithm) gets one record: nanosecond
+// steady_clock samples of R runs after W untimed ones, summarized as min,
+// p10, median, p90, max and mean. Each run is checked against
+// dijkstra_binary and the exit code is 1 if any fails.
+//
+// Families, each with shuffled labels and edge order:
+//   adversarial  the decrease-key-heavy graph: edges from 0 to everything and
+//                from u to u + 1, ..., u + D, costs decreasing in insertion
+//                order so that later vertices keep getting cheaper
+//   random       G(n, m) with m = nD and costs uniform in [1, C]
+//   grid         a floor(sqrt(N))^2 grid, both directions, cost in [1, C]
+//   powerlaw     preferential attachment with D edges per vertex, both
+//                directions, cost in [1, C]
+// A size NxD overrides degree for that size. cost=C != 0 also maps every
+// adversarial cost c to 1 + c % C; the other families default to 2^20.
+//
+// Algorithms: fibonacci, binary, radix, compact, pairing, dary, dial, naive
+// and delta[:T] compute all distances from the source on each layout, where
+// list is vector<vector<edge_type>> and the others are csr_graph in identity,
+// bfs_order, rcm_order or degree_order. The query algorithms to, reused,
+// bidirectional, astar and ch time one query to a random target per run on
+// list; ch builds, saves and maps the hierarchy once beforehand, and ch-build
+// times the build alone. dial is skipped if a cost exceeds 2^20.
+//
+// update_key and decrease_key count the calls of one untimed run, and the
+// calls that lowered a finite key, for the algorithms going through
+// dijkstra_decrease_key. perf=1 adds the median cache and branch misses per
+// run from perf_event_open, including threads. Unavailable values are empty
+// in CSV and null in JSON.
+
+namespace {
+
+using i64 = std::int64_t;
+
+// Forwards to Heap and counts update_key calls.
+template <class Heap> class counting_heap {
+  using T = decltype(std::declval<Heap &>().pop().cost);
+
+  Heap heap;
+  vector<T> key;
+
+public:
+  u64 calls;
+  u64 decreases;
+
+  counting_heap(const usize n)
+      : heap(n), key(n, inf<T>), calls(0), decreases(0) {}
+
+  bool empty() const { return heap.empty(); }
+
+  edge_type<T> pop() { return heap.pop(); }
+
+  void update_key(const usize v, const T k) {
+    calls += 1;
+    if (k < key[v]) {
+      decreases += key[v] != inf<T>;
+      key[v] = k;
+    }
+    heap.update_key(v, k);
+  }
+};
+
+class perf_counters {
+  std::array<int, 2> fds;
+
+  static int open_counter(const u64 config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  void close_all() {
+    for (int &fd : fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      fd = -1;
+    }
+  }
+
+public:
+  explicit perf_counters(const bool enable) : fds{-1, -1} {
+    if (!enable) {
+      return;
+    }
+    fds[0] = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+    fds[1] = open_counter(PERF_COUNT_HW_BRANCH_MISSES);
+    if (fds[0] < 0 || fds[1] < 0) {
+      std::fprintf(stderr, "perf_event_open failed: %s\n",
+                   std::strerror(errno));
+      close_all();
+    }
+  }
+
+  ~perf_counters() { close_all(); }
+
+  perf_counters(const perf_counters &) = delete;
+  perf_counters &operator=(const perf_counters &) = delete;
+
+  bool enabled() const { return fds[0] >= 0; }
+
+  void start() {
+    for (const int fd : fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  // Cache and branch misses since start, -1 if unavailable.
+  std::array<i64, 2> stop() {
+    std::array<i64, 2> ret = {-1, -1};
+    for (usize i = 0; i != 2; i += 1) {
+      u64 count;
+      if (fds[i] >= 0) {
+        ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fds[i], &count, sizeof(count)) == sizeof(count)) {
+          ret[i] = i64(count);
+        }
+      }
+    }
+    return ret;
+  }
+};
+
+using graph_type = vector<vector<edge_type<u64>>>;
+
+class instance {
+public:
+  std::string family;
+  graph_type graph;
+  usize source;
+  usize edges;
+};
+
+template <class T> struct edge_info {
   usize u, v;
   T cost;
 };
 
-void run(const usize n, const usize deg, const bool run_naive) {
+// Relabels vertices at random and shuffles edges, with 0 as the source.
+instance build(std::string family, const usize n,
+               vector<edge_info<u64>> edges, std::mt19937_64 &rng) {
+  instance ret{std::move(family), graph_type(n), 0, edges.size()};
+  std::shuffle(edges.begin(), edges.end(), rng);
+  vector<usize> map(n);
+  std::iota(map.begin(), map.end(), usize(0));
+  std::shuffle(map.begin(), map.end(), rng);
+  for (const auto &e : edges) {
+    ret.graph[map[e.u]].push_back({map[e.v], e.cost});
+  }
+  ret.source = map[0];
+  return ret;
+}
+
+instance generate(const std::string &family, const usize n, const usize deg,
+                  const u64 cost, const u64 seed) {
+  std::mt19937_64 rng(seed);
+  const u64 max_cost = cost == 0 ? u64(1) << 20 : cost;
+  const auto random_cost = [&]() -> u64 { return 1 + rng() % max_cost; };
   vector<edge_info<u64>> edges;
-  {
+  if (family == "adversarial") {
     u64 next = u64(1) << 32;
     edges.push_back({0, 1, 1});
     for (usize v = 2; v != n; v += 1) {
       edges.push_back({0, v, next});
       next -= 1;
     }
-    for (usize u = 1; u + 1 != n; u += 1) {
+    for (usize u = 1; u + 1 < n; u += 1) {
       edges.push_back({u, u + 1, 1});
       for (usize v = u + 2; v != n && v != u + deg + 1; v += 1) {
         edges.push_back({u, v, next - u});
         next -= 1;
       }
     }
+    if (cost != 0) {
+      for (auto &e : edges) {
+        e.cost = 1 + e.cost % cost;
+      }
+    }
+    return build(family, n, std::move(edges), rng);
+  }
+  if (family == "random") {
+    edges.reserve(n * deg);
+    while (n > 1 && edges.size() != n * deg) {
+      const usize u = rng() % n;
+      const usize v = rng() % n;
+      if (u != v) {
+        edges.push_back({u, v, random_cost()});
+      }
+    }
+    return build(family, n, std::move(edges), rng);
+  }
+  if (family == "grid") {
+    const usize side = std::sqrt(double(n));
+    for (usize i = 0; i != side; i += 1) {
+      for (usize j = 0; j != side; j += 1) {
+        const usize v = i * side + j;
+        for (const usize u : {i + 1 != side ? v + side : v,
+                              j + 1 != side ? v + 1 : v}) {
+          if (u != v) {
+            const u64 c = random_cost();
+            edges.push_back({v, u, c});
+            edges.push_back({u, v, c});
+          }
+        }
+      }
+    }
+    return build(family, side * side, std::move(edges), rng);
+  }
+  if (family == "powerlaw") {
+    // Half of the endpoints are uniform and half proportional to degree,
+    // which gives a power-law degree distribution.
+    vector<usize> ends;
+    for (usize v = 1; v != n; v += 1) {
+      for (usize k = 0; k != std::min(v, deg); k += 1) {
+        const usize u = ends.empty() || rng() % 2 == 0
+                            ? rng() % v
+                            : ends[rng() % ends.size()];
+        const u64 c = random_cost();
+        edges.push_back({v, u, c});
+        edges.push_back({u, v, c});
+        ends.push_back(u);
+        ends.push_back(v);
+      }
+    }
+    return build(family, n, std::move(edges), rng);
   }
+  std::fprintf(stderr, "unknown family: %s\n", family.c_str());
+  std::exit(2);
+}
 
-  usize source;
-  vector<vector<edge_type<u64>>> graph(n);
-  {
-    std::mt19937_64 rnd(91);
-    std::shuffle(edges.begin(), edges.end(), rnd);
-    vector<usize> map(n);
-    std::iota(map.begin(), map.end(), usize(0));
-    std::shuffle(map.begin(), map.end(), rnd);
-    for (const auto &e : edges) {
-      graph[map[e.u]].push_back({map[e.v], e.cost});
-    }
-    source = map[0];
-  }
-
-  std::cout << "V = " << n << ", E = " << edges.size() << "\n";
-
-  const auto ans = dijkstra_fibonacci(graph, source);
-
-  const auto time_median = [&](auto f) -> int {
-    std::vector<int> times;
-    for (usize i = 0; i != 15; i += 1) {
-      const auto start = std::chrono::system_clock::now();
-      const auto res = f();
-      const auto end = std::chrono::system_clock::now();
-      const auto span =
-          std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
-              .count();
-      times.push_back(span);
-      assert(res == ans);
-    }
-    std::sort(times.begin(), times.end());
-    return times[times.size() / 2];
+// The names run_sssp and run_queries recognize; delta takes an optional
+// :T with T >= 1.
+bool known_algorithm(const std::string &name) {
+  static const vector<std::string> names = {
+      "fibonacci", "binary", "radix",  "compact",       "pairing",
+      "dary",      "dial",   "naive",  "delta",         "to",
+      "reused",    "astar",  "ch",     "bidirectional", "ch-build"};
+  if (std::find(names.begin(), names.end(), name) != names.end()) {
+    return true;
+  }
+  if (name.compare(0, 6, "delta:") != 0 || name.size() == 6) {
+    return false;
+  }
+  for (usize i = 6; i != name.size(); i += 1) {
+    if (name[i] < '0' || name[i] > '9') {
+      return false;
+    }
+  }
+  return std::stoul(name.substr(6)) != 0;
+}
+
+vector<std::string> split(const std::string &s) {
+  vector<std::string> ret;
+  usize p = 0;
+  while (p <= s.size()) {
+    const usize q = std::min(s.find(',', p), s.size());
+    if (q != p) {
+      ret.push_back(s.substr(p, q - p));
+    }
+    p = q + 1;
+  }
+  return ret;
+}
+
+class options {
+public:
+  usize runs = 15;
+  usize warmup = 2;
+  usize threads = std::max(1u, std::thread::hardware_concurrency());
+  bool csv = false;
+};
+
+class record {
+public:
+  std::string algorithm;
+  std::string layout;
+  vector<u64> ns;
+  vector<i64> cache_misses;
+  vector<i64> branch_misses;
+  i64 update_key;
+  i64 decrease_key;
+  bool ok;
+
+  record(std::string algorithm_, std::string layout_)
+      : algorithm(std::move(algorithm_)), layout(std::move(layout_)), ns(),
+        cache_misses(), branch_misses(), update_key(-1), decrease_key(-1),
+        ok(true) {}
+};
+
+int failures = 0;
+
+template <class U> U quantile(vector<U> v, const double p) {
+  std::sort(v.begin(), v.end());
+  return v[usize(p * (v.size() - 1) + 0.5)];
+}
+
+void print(const options &opt, const instance &g, const record &r) {
+  const auto value = [&](const i64 x) -> std::string {
+    return x >= 0 ? std::to_string(x) : opt.csv ? "" : "null";
   };
-  {
-    const int fib =
-        time_median([&]() { return dijkstra_fibonacci(graph, source); });
-    std::cout << fib << " ";
+  const auto median = [&](const vector<i64> &v) -> std::string {
+    return value(v.empty() ? -1 : quantile(v, 0.5));
+  };
+  const double mean =
+      std::accumulate(r.ns.begin(), r.ns.end(), 0.0) / r.ns.size();
+  const char *const format =
+      opt.csv ? "%s,%zu,%zu,%s,%s,%zu,%zu,%llu,%llu,%llu,%llu,%llu,%.0f,%s,%s,"
+                "%s,%s,%s\n"
+              : "{\"family\":\"%s\",\"n\":%zu,\"m\":%zu,\"layout\":\"%s\","
+                "\"algorithm\":\"%s\",\"runs\":%zu,\"warmup\":%zu,"
+                "\"min_ns\":%llu,\"p10_ns\":%llu,\"median_ns\":%llu,"
+                "\"p90_ns\":%llu,\"max_ns\":%llu,\"mean_ns\":%.0f,"
+                "\"update_key\":%s,\"decrease_key\":%s,\"cache_misses\":%s,"
+                "\"branch_misses\":%s,\"ok\":%s}\n";
+  std::printf(format, g.family.c_str(), g.graph.size(), g.edges,
+              r.layout.c_str(), r.algorithm.c_str(), r.ns.size(), opt.warmup,
+              (unsigned long long)quantile(r.ns, 0),
+              (unsigned long long)quantile(r.ns, 0.1),
+              (unsigned long long)quantile(r.ns, 0.5),
+              (unsigned long long)quantile(r.ns, 0.9),
+              (unsigned long long)quantile(r.ns, 1), mean,
+              value(r.update_key).c_str(), value(r.decrease_key).c_str(),
+              median(r.cache_misses).c_str(), median(r.branch_misses).c_str(),
+              r.ok ? "true" : "false");
+  std::fflush(stdout);
+  failures += !r.ok;
+}
+
+// Runs f(i) warmup + runs times and times the last runs; check(i, result)
+// runs outside the timed region.
+template <class F, class C>
+void measure(const options &opt, perf_counters &perf, record &r, F f, C check) {
+  using clock = std::chrono::steady_clock;
+  for (usize i = 0; i != opt.warmup; i += 1) {
+    r.ok &= check(i, f(i));
   }
-  {
-    const int bin =
-        time_median([&]() { return dijkstra_binary(graph, source); });
-    std::cout << bin << " ";
+  for (usize i = opt.warmup; i != opt.warmup + opt.runs; i += 1) {
+    perf.start();
+    const auto start = clock::now();
+    const auto res = f(i);
+    const auto end = clock::now();
+    const auto misses = perf.stop();
+    r.ns.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+    if (perf.enabled()) {
+      r.cache_misses.push_back(misses[0]);
+      r.branch_misses.push_back(misses[1]);
+    }
+    r.ok &= check(i, res);
   }
-  if (run_naive) {
-    const int naive =
-        time_median([&]() { return dijkstra_naive(graph, source); });
-    std::cout << naive << " ";
+}
+
+template <class Heap, class Graph>
+void count_keys(record &r, const Graph &graph, const usize source) {
+  counting_heap<Heap> heap(graph.size());
+  dijkstra_decrease_key(graph, source, heap);
+  r.update_key = heap.calls;
+  r.decrease_key = heap.decreases;
+}
+
+// All-distance algorithms on graph, a relabeling of g.graph by map.
+template <class Graph>
+void run_sssp(const options &opt, perf_counters &perf, const instance &g,
+              const vector<u64> &ans, const std::string &layout,
+              const Graph &graph, const vector<usize> &map,
+              const vector<std::string> &algorithms) {
+  const usize n = graph.size();
+  const usize source = map[g.source];
+  u64 max_cost = 0;
+  for (usize v = 0; v != n; v += 1) {
+    for (const auto &e : graph[v]) {
+      max_cost = std::max(max_cost, e.cost);
+    }
+  }
+  const auto check = [&](usize, const vector<u64> &dist) {
+    for (usize v = 0; v != n; v += 1) {
+      if (dist[map[v]] != ans[v]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  const auto time = [&](record &r, auto f) {
+    measure(opt, perf, r, [&](usize) { return f(); }, check);
+  };
+  for (const std::string &name : algorithms) {
+    record r(name, layout);
+    if (name == "fibonacci") {
+      time(r, [&]() { return dijkstra_fibonacci(graph, source); });
+      count_keys<fibonacci_heap<u64>>(r, graph, source);
+    } else if (name == "binary") {
+      time(r, [&]() { return dijkstra_binary(graph, source); });
+    } else if (name == "radix") {
+      time(r, [&]() { return dijkstra_radix(graph, source); });
+    } else if (name == "compact") {
+      time(r, [&]() {
+        return dijkstra_decrease_key<compact_fibonacci_heap<u64>>(graph,
+                                                                  source);
+      });
+      count_keys<compact_fibonacci_heap<u64>>(r, graph, source);
+    } else if (name == "pairing") {
+      time(r, [&]() {
+        return dijkstra_decrease_key<pairing_heap<u64>>(graph, source);
+      });
+      count_keys<pairing_heap<u64>>(r, graph, source);
+    } else if (name == "dary") {
+      time(r, [&]() {
+        return dijkstra_decrease_key<dary_heap<u64, 4>>(graph, source);
+      });
+      count_keys<dary_heap<u64, 4>>(r, graph, source);
+    } else if (name == "dial") {
+      if (max_cost > (u64(1) << 20)) {
+        std::fprintf(stderr, "dial skipped: cost %llu\n",
+                     (unsigned long long)max_cost);
+        continue;
+      }
+      time(r, [&]() { return dijkstra_dial(graph, source); });
+    } else if (name == "naive") {
+      time(r, [&]() { return dijkstra_naive(graph, source); });
+    } else if (name.compare(0, 5, "delta") == 0) {
+      const usize threads =
+          name.size() > 6 && name[5] == ':'
+              ? std::max<usize>(1, std::stoul(name.substr(6)))
+              : opt.threads;
+      time(r, [&]() { return delta_stepping(graph, source, u64(0), threads); });
+    } else {
+      continue;
+    }
+    print(opt, g, r);
   }
-  std::cout << "\n";
 }
 
-int main() {
+// Point-to-point algorithms from the source to random targets.
+void run_queries(const options &opt, perf_counters &perf, const instance &g,
+                 const vector<u64> &ans, const vector<std::string> &algorithms,
+                 const u64 seed) {
+  const graph_type &graph = g.graph;
+  const usize n = graph.size();
+  const usize source = g.source;
+  std::mt19937_64 rnd(seed);
+  vector<usize> targets(opt.warmup + opt.runs);
+  for (usize &t : targets) {
+    t = rnd() % n;
+  }
+  const auto check = [&](const usize i, const u64 d) {
+    return d == ans[targets[i]];
+  };
+  point_to_point<u64> query(n);
+  for (const std::string &name : algorithms) {
+    record r(name, "list");
+    if (name == "to") {
+      measure(opt, perf, r,
+              [&](const usize i) {
+                return dijkstra_to(graph, source, targets[i]);
+              },
+              check);
+    } else if (name == "reused") {
+      measure(opt, perf, r,
+              [&](const usize i) {
+                return query.to(graph, source, targets[i]);
+              },
+              check);
+    } else if (name == "bidirectional") {
+      const auto reverse = reverse_graph(graph);
+      measure(opt, perf, r,
+              [&](const usize i) {
+                return query.bidirectional(graph, reverse, source, targets[i]);
+              },
+              check);
+    } else if (name == "astar") {
+      // The potential is max(0, d(L, t) - d(L, v)) for a random landmark L.
+      const auto landmark = dijkstra_binary(graph, usize(rnd() % n));
+      measure(opt, perf, r,
+              [&](const usize i) {
+                const usize t = targets[i];
+                return query.astar(graph, source, t, [&](const usize v) -> u64 {
+                  if (landmark[t] == inf<u64> || landmark[v] == inf<u64> ||
+                      landmark[t] < landmark[v]) {
+                    return 0;
+                  }
+                  return landmark[t] - landmark[v];
+                });
+              },
+              check);
+    } else if (name == "ch") {
+      const char *const path = "dijkstra_experiment.ch";
+      const bool saved = contraction_hierarchy<u64>(graph).save(path);
+      try {
+        const contraction_hierarchy<u64> ch(path);
+        std::remove(path);
+        r.ok = saved && ch.size() == n;
+        measure(opt, perf, r,
+                [&](const usize i) {
+                  return query.hierarchy(ch, source, targets[i]);
+                },
+                check);
+      } catch (const std::runtime_error &e) {
+        std::remove(path);
+        std::fprintf(stderr, "%s\n", e.what());
+        failures += 1;
+        continue;
+      }
+    } else if (name == "ch-build") {
+      measure(opt, perf, r,
+              [&](usize) {
+                return contraction_hierarchy<u64>(graph).edge_count();
+              },
+              [](usize, usize) { return true; });
+    } else {
+      continue;
+    }
+    print(opt, g, r);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  options opt;
+  vector<std::string> families = {"adversarial"};
+  vector<std::string> sizes = {"1500000x3", "500000x20", "5000x5000"};
+  vector<std::string> algorithms = {"fibonacci", "binary", "radix", "compact",
+                                    "pairing",   "dary",   "dial",  "delta"};
+  vector<std::string> layouts = {"list"};
+  usize degree = 3;
+  u64 cost = 0;
+  bool perf_enabled = false;
+  u64 seed = 91;
+  for (int i = 1; i < argc; i += 1) {
+    const std::string arg = argv[i];
+    const usize eq = arg.find('=');
+    const std::string key = arg.substr(0, eq);
+    const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (key == "families") {
+      families = split(value);
+    } else if (key == "sizes") {
+      sizes = split(value);
+    } else if (key == "degree") {
+      degree = std::stoul(value);
+    } else if (key == "cost") {
+      cost = std::stoull(value);
+    } else if (key == "algorithms") {
+      algorithms = split(value);
+    } else if (key == "layouts") {
+      layouts = split(value);
+    } else if (key == "runs") {
+      opt.runs = std::max<usize>(1, std::stoul(value));
+    } else if (key == "warmup") {
+      opt.warmup = std::stoul(value);
+    } else if (key == "threads") {
+      opt.threads = std::max<usize>(1, std::stoul(value));
+    } else if (key == "perf") {
+      perf_enabled = value != "0";
+    } else if (key == "format") {
+      opt.csv = value == "csv";
+    } else if (key == "seed") {
+      seed = std::stoull(value);
+    } else {
+      std::fprintf(stderr, "unknown argument: %s\n", arg.c_str());
+      return 2;
+    }
+  }
+  for (const std::string &name : algorithms) {
+    if (!known_algorithm(name)) {
+      std::fprintf(stderr, "unknown algorithm: %s\n", name.c_str());
+      return 2;
+    }
+  }
 
-  run(1500000, 3, false);
-  run(500000, 20, false);
-  run(5000, 5000, true);
+  perf_counters perf(perf_enabled);
+  if (opt.csv) {
+    std::printf("family,n,m,layout,algorithm,runs,warmup,min_ns,p10_ns,"
+                "median_ns,p90_ns,max_ns,mean_ns,update_key,decrease_key,"
+                "cache_misses,branch_misses,ok\n");
+  }
+  for (const std::string &size : sizes) {
+    const usize x = size.find('x');
+    const usize n = std::stoul(size.substr(0, x));
+    const usize deg =
+        x == std::string::npos ? degree : std::stoul(size.substr(x + 1));
+    for (const std::string &family : families) {
+      const instance g = generate(family, n, deg, cost, seed);
+      const vector<u64> ans = dijkstra_binary(g.graph, g.source);
+      for (const std::string &layout : layouts) {
+        vector<usize> map;
+        if (layout == "list" || layout == "csr") {
+          map.resize(g.graph.size());
+          std::iota(map.begin(), map.end(), usize(0));
+        } else if (layout == "bfs") {
+          map = bfs_order(g.graph, g.source);
+        } else if (layout == "rcm") {
+          map = rcm_order(g.graph);
+        } else if (layout == "degree") {
+          map = degree_order(g.graph);
+        } else {
+          std::fprintf(stderr, "unknown layout: %s\n", layout.c_str());
+          return 2;
+        }
+        if (layout == "list") {
+          run_sssp(opt, perf, g, ans, layout, g.graph, map, algorithms);
+        } else {
+          run_sssp(opt, perf, g, ans, layout, csr_graph<u64>(g.graph, map),
+                   map, algorithms);
+        }
+      }
+      run_queries(opt, perf, g, ans, algorithms, seed);
+    }
+  }
 
-  return 0;
+  return failures == 0 ? 0 : 1;
 }
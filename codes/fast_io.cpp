@@ -0,0 +1,188 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+// Reports a failed system call and aborts; input cut short or output lost
+// would otherwise go unnoticed.
+[[noreturn]] inline void fast_io_fail(const char *const what) {
+  std::fprintf(stderr, "%s: %s\n", what, std::strerror(errno));
+  std::abort();
+}
+
+// Integer tokenizer over a whole file. Regular files are mapped, anything
+// else (pipes, terminals) is read into memory in large blocks.
+class fast_input {
+  using usize = std::size_t;
+
+  const char *p;
+  const char *end;
+  void *map;
+  usize map_size;
+  std::vector<char> buf;
+
+  void open(const int fd) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      void *const m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m != MAP_FAILED) {
+        madvise(m, st.st_size, MADV_SEQUENTIAL);
+        map = m;
+        map_size = st.st_size;
+        p = static_cast<const char *>(m);
+        end = p + map_size;
+        return;
+      }
+    }
+    usize len = 0;
+    buf.resize(usize(1) << 16);
+    while (true) {
+      if (len == buf.size()) {
+        buf.resize(buf.size() * 2);
+      }
+      const ssize_t r = ::read(fd, buf.data() + len, buf.size() - len);
+      if (r == 0) {
+        break;
+      }
+      if (r < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        fast_io_fail("read");
+      }
+      len += r;
+    }
+    p = buf.data();
+    end = p + len;
+  }
+
+public:
+  explicit fast_input(const int fd = 0)
+      : p(nullptr), end(nullptr), map(nullptr), map_size(0), buf() {
+    open(fd);
+  }
+
+  explicit fast_input(const char *const path)
+      : p(nullptr), end(nullptr), map(nullptr), map_size(0), buf() {
+    int fd;
+    do {
+      fd = ::open(path, O_RDONLY);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) {
+      fast_io_fail(path);
+    }
+    open(fd);
+    ::close(fd);
+  }
+
+  ~fast_input() {
+    if (map != nullptr) {
+      munmap(map, map_size);
+    }
+  }
+
+  fast_input(const fast_input &) = delete;
+  fast_input &operator=(const fast_input &) = delete;
+
+  bool eof() {
+    while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+      p += 1;
+    }
+    return p == end;
+  }
+
+  template <class T> T read() {
+    static_assert(std::is_integral_v<T>);
+    eof();
+    bool neg = false;
+    if constexpr (std::is_signed_v<T>) {
+      if (p != end && *p == '-') {
+        neg = true;
+        p += 1;
+      }
+    }
+    T ret = 0;
+    while (p != end && unsigned(*p - '0') < 10) {
+      ret = ret * 10 + (*p - '0');
+      p += 1;
+    }
+    return neg ? -ret : ret;
+  }
+};
+
+// Block-buffered writer on a file descriptor, flushed when full and on
+// destruction.
+class fast_output {
+  using usize = std::size_t;
+
+  static constexpr usize size = usize(1) << 16;
+
+  int fd;
+  usize len;
+  char buf[size];
+
+public:
+  explicit fast_output(const int fd_ = 1) : fd(fd_), len(0) {}
+  ~fast_output() { flush(); }
+
+  fast_output(const fast_output &) = delete;
+  fast_output &operator=(const fast_output &) = delete;
+
+  void flush() {
+    usize done = 0;
+    while (done != len) {
+      const ssize_t r = ::write(fd, buf + done, len - done);
+      if (r < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        fast_io_fail("write");
+      }
+      done += r;
+    }
+    len = 0;
+  }
+
+  void put(const char c) {
+    if (len == size) {
+      flush();
+    }
+    buf[len++] = c;
+  }
+
+  template <class T> void write(T x) {
+    static_assert(std::is_integral_v<T>);
+    if (size - len < 24) {
+      flush();
+    }
+    std::make_unsigned_t<T> u = x;
+    if constexpr (std::is_signed_v<T>) {
+      if (x < 0) {
+        buf[len++] = '-';
+        u = -u;
+      }
+    }
+    char tmp[24];
+    int n = 0;
+    do {
+      tmp[n++] = '0' + u % 10;
+      u /= 10;
+    } while (u != 0);
+    while (n != 0) {
+      buf[len++] = tmp[--n];
+    }
+  }
+
+  void write(const char *s) {
+    while (*s != '\0') {
+      put(*s++);
+    }
+  }
+};
@@ -0,0 +1,177 @@
+#include "auto_memoization.cpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using u64 = std::uint64_t;
+using usize = std::size_t;
+using std::vector;
+
+// Usage: memoization_benchmark [states]
+// Each recursion visits about states argument tuples (10^7 by default) and is
+// checked against a bottom-up loop. The dense tables cover the whole square,
+// about twice and four times states entries. The chain recurses states levels
+// deep, which only stack_safe survives.
+
+template <class F> u64 time_ms(F f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+      .count();
+}
+
+template <class R, class Run>
+void bench(const char *name, const R expected, Run run) {
+  R res = 0;
+  const u64 ms = time_ms([&]() { res = run(); });
+  std::cout << "  " << name << " " << ms << " ms"
+            << (res == expected ? "" : " WRONG") << "\n";
+  if (res != expected) {
+    std::exit(1);
+  }
+}
+
+// Longest common subsequence of two random strings of length n, n^2 states.
+void bench_lcs(const usize n) {
+  std::mt19937_64 rng(91);
+  std::string a(n, 'a'), b(n, 'a');
+  for (char &c : a) {
+    c = 'a' + rng() % 4;
+  }
+  for (char &c : b) {
+    c = 'a' + rng() % 4;
+  }
+
+  vector<vector<int>> dp(n + 1, vector<int>(n + 1, 0));
+  const u64 loop_ms = time_ms([&]() {
+    for (usize i = 1; i <= n; i += 1) {
+      for (usize j = 1; j <= n; j += 1) {
+        dp[i][j] = a[i - 1] == b[j - 1]
+                       ? dp[i - 1][j - 1] + 1
+                       : std::max(dp[i - 1][j], dp[i][j - 1]);
+      }
+    }
+  });
+  const int expected = dp[n][n];
+  std::cout << "lcs n = " << n << ": loop " << loop_ms << " ms\n";
+
+  const auto lcs = [&](auto &self, const int i, const int j) -> int {
+    if (i == 0 || j == 0) {
+      return 0;
+    }
+    if (a[i - 1] == b[j - 1]) {
+      return self(i - 1, j - 1) + 1;
+    }
+    return std::max(self(i - 1, j), self(i, j - 1));
+  };
+  bench("dense", expected,
+        [&]() { return memoized_dense(lcs, n + 1, n + 1)(int(n), int(n)); });
+  bench("hash", expected, [&]() { return memoized(lcs)(int(n), int(n)); });
+  bench("stack_safe hash", expected,
+        [&]() { return stack_safe(memoized(lcs))(int(n), int(n)); });
+  bench("map", expected,
+        [&]() { return memoized_ordered(lcs)(int(n), int(n)); });
+}
+
+// C(n, n / 2) mod 998244353 by Pascal's rule, about n^2 / 4 states.
+void bench_binomial(const int n) {
+  constexpr u64 mod = 998244353;
+  vector<u64> row(n + 1, 0);
+  const u64 loop_ms = time_ms([&]() {
+    row[0] = 1;
+    for (int i = 1; i <= n; i += 1) {
+      for (int k = i; k != 0; k -= 1) {
+        row[k] = (row[k] + row[k - 1]) % mod;
+      }
+    }
+  });
+  const u64 expected = row[n / 2];
+  std::cout << "binomial n = " << n << ": loop " << loop_ms << " ms\n";
+
+  const auto binom = [&](auto &self, const int i, const int k) -> u64 {
+    if (k == 0 || k == i) {
+      return 1;
+    }
+    return (self(i - 1, k - 1) + self(i - 1, k)) % mod;
+  };
+  bench("dense", expected,
+        [&]() { return memoized_dense(binom, n + 1, n + 1)(n, n / 2); });
+  bench("hash", expected, [&]() { return memoized(binom)(n, n / 2); });
+  bench("map", expected,
+        [&]() { return memoized_ordered(binom)(n, n / 2); });
+}
+
+// f(i) = 31 f(i - 1) + i mod 10^9 + 7, as deep as it has states.
+void bench_chain(const int n) {
+  constexpr u64 mod = 1000000007;
+  u64 expected = 0;
+  const u64 loop_ms = time_ms([&]() {
+    for (int i = 1; i <= n; i += 1) {
+      expected = (expected * 31 + i) % mod;
+    }
+  });
+  std::cout << "chain n = " << n << ": loop " << loop_ms << " ms\n";
+
+  const auto chain = [&](auto &self, const int i) -> u64 {
+    return i == 0 ? 0 : (self(i - 1) * 31 + i) % mod;
+  };
+  bench("stack_safe dense", expected,
+        [&]() { return stack_safe(memoized_dense(chain, n + 1))(n); });
+  bench("stack_safe hash", expected,
+        [&]() { return stack_safe(memoized(chain))(n); });
+}
+
+int main(int argc, char **argv) {
+  const double states = argc > 1 ? std::atof(argv[1]) : 1e7;
+  bench_lcs(usize(std::sqrt(states)));
+  bench_binomial(int(2 * std::sqrt(states)));
+  bench_chain(int(states));
+
+  const auto binom = [](auto &self, const int i, const int k) -> u64 {
+    return k == 0 || k == i ? 1 : self(i - 1, k - 1) + self(i - 1, k);
+  };
+  if (memoized_dense<31, 31>(binom)(30, 15) != 155117520) {
+    std::cout << "memoized_dense<31, 31> WRONG\n";
+    return 1;
+  }
+
+  // A stack_safe memo called at every level of another, so also from near
+  // the bottom of its segments. Each call goes 100 levels of 512 bytes or
+  // more deeper, past the end of such a segment.
+  constexpr u64 mod = 1000000007;
+  const auto chain = [&](auto &self, const int i) -> u64 {
+    volatile char frame[512];
+    frame[0] = 0;
+    return i == 0 ? frame[0] : (self(i - 1) * 31 + i) % mod;
+  };
+  auto inner = stack_safe(memoized(chain), 1 << 16);
+  const auto outer = [&](auto &self, const int i) -> u64 {
+    if (i == 0) {
+      return 0;
+    }
+    const u64 below = self(i - 1);
+    return (below + inner(100 * i)) % mod;
+  };
+  const int depth = 10000;
+  u64 expected = 0;
+  for (int i = 1, c = 0; i <= 100 * depth; i += 1) {
+    c = (u64(c) * 31 + i) % mod;
+    if (i % 100 == 0) {
+      expected = (expected + c) % mod;
+    }
+  }
+  if (stack_safe(memoized(outer), 1 << 16)(depth) != expected) {
+    std::cout << "nested stack_safe WRONG\n";
+    return 1;
+  }
+  return 0;
+}
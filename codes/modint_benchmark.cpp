@@ -0,0 +1,151 @@
+#include "modint_combination.cpp"
+#include "modint_simd.cpp"
+#include "montgomery_modint.cpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using u64 = std::uint64_t;
+using usize = std::size_t;
+using std::vector;
+
+constexpr u64 mod = 998244353;
+
+static_assert((montgomery_modint<mod>(3) / montgomery_modint<mod>(2)).val() ==
+              (modint<mod>(3) / modint<mod>(2)).v);
+
+template <class F> u64 time_ms(F f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+      .count();
+}
+
+template <class M, class G>
+void bench_chain(const char *name, const vector<u64> &in, const usize rep,
+                 G get) {
+  const vector<M> a(in.begin(), in.end());
+  vector<M> b(a.rbegin(), a.rend());
+  M add(0), mul(1), div(1);
+  const u64 add_ms = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      for (const M x : a)
+        add += x;
+  });
+  const u64 mul_ms = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      for (const M x : a)
+        mul *= x;
+  });
+  const u64 div_ms = time_ms([&]() {
+    for (const M x : a)
+      div /= x;
+  });
+  const u64 vec_ms = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      for (usize i = 0; i != a.size(); i += 1)
+        b[i] *= a[i];
+  });
+  std::cout << name << ": add " << add_ms << " ms, mul " << mul_ms
+            << " ms, div " << div_ms << " ms, pointwise mul " << vec_ms
+            << " ms  (" << get(add) << " " << get(mul) << " " << get(div)
+            << " " << get(b[0]) << ")\n";
+}
+
+void bench_simd(const vector<u64> &in, const usize rep) {
+  using M = modint<mod>;
+  const vector<M> x(in.begin(), in.end());
+  const vector<M> y0(in.rbegin(), in.rend());
+  const M a(91);
+  const usize n = x.size();
+  const auto same = [](const vector<M> &l, const vector<M> &r) {
+    for (usize i = 0; i != l.size(); i += 1)
+      if (l[i].v != r[i].v)
+        return false;
+    return true;
+  };
+
+  vector<M> y = y0, z = y0;
+  const u64 axpy_scalar = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      for (usize i = 0; i != n; i += 1)
+        y[i] += a * x[i];
+  });
+  const u64 axpy_simd = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      modint_simd::axpy(a, x.data(), z.data(), n);
+  });
+  const bool axpy_ok = same(y, z);
+
+  y = y0, z = y0;
+  const u64 mul_scalar = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      for (usize i = 0; i != n; i += 1)
+        y[i] *= x[i];
+  });
+  const u64 mul_simd = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      modint_simd::mul(x.data(), z.data(), n);
+  });
+  const bool mul_ok = same(y, z);
+
+  M ds = 0, dv = 0;
+  const u64 dot_scalar = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      for (usize i = 0; i != n; i += 1)
+        ds += x[i] * y0[i];
+  });
+  const u64 dot_simd = time_ms([&]() {
+    for (usize r = 0; r != rep; r += 1)
+      dv += modint_simd::dot(x.data(), y0.data(), n);
+  });
+  const bool dot_ok = ds.v == dv.v;
+
+  std::cout << "batch kernels (scalar / simd, isa "
+            << int(modint_simd::detect()) << "): axpy " << axpy_scalar << " / "
+            << axpy_simd << " ms, mul " << mul_scalar << " / " << mul_simd
+            << " ms, dot " << dot_scalar << " / " << dot_simd << " ms  ("
+            << axpy_ok << mul_ok << dot_ok << ")\n";
+}
+
+// A first call with n = 0 must not walk the new table down past t[0].
+bool factorial_table_from_zero() {
+  using M = modint<mod>;
+  factorial_table<M> table;
+  if (table.binom(0, 0).v != 1 || table.fact(0).v != 1)
+    return false;
+  for (usize i = 1; i <= 100; i += 1)
+    if ((table.fact(i) * table.inv_fact(i)).v != 1 ||
+        (table.inv(i) * M(i)).v != 1)
+      return false;
+  return true;
+}
+
+int main() {
+  if (!factorial_table_from_zero()) {
+    std::cout << "factorial_table from n = 0 differs\n";
+    return 1;
+  }
+
+  const usize n = 1 << 20;
+  const usize rep = 100;
+  vector<u64> in(n);
+  std::mt19937_64 rnd(91);
+  for (u64 &x : in)
+    x = rnd() % (mod - 1) + 1;
+
+  std::cout << "n = " << n << ", add/mul x" << rep << ", div x1\n";
+  bench_chain<modint<mod>>("modint            ", in, rep,
+                           [](const modint<mod> x) { return x.v; });
+  bench_chain<montgomery_modint<mod>>(
+      "montgomery_modint ", in, rep,
+      [](const montgomery_modint<mod> x) { return x.val(); });
+  bench_simd(in, rep);
+
+  return 0;
+}
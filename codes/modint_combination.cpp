@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// M is modint<mod> (modint.cpp) or modint (runtime_modint.cpp).
+
+// 3(n - 1) multiplications and one division. Every a[i] must be invertible.
+template <class M> std::vector<M> batch_inverse(const std::vector<M> &a) {
+  const std::size_t n = a.size();
+  std::vector<M> ret(n);
+  if (n == 0)
+    return ret;
+  ret[0] = a[0];
+  for (std::size_t i = 1; i != n; i += 1)
+    ret[i] = ret[i - 1] * a[i];
+  M inv = M(1) / ret[n - 1];
+  for (std::size_t i = n - 1; i != 0; i -= 1) {
+    ret[i] = inv * ret[i - 1];
+    inv *= a[i];
+  }
+  ret[0] = inv;
+  return ret;
+}
+
+// Tables grow geometrically on demand and are rebuilt if the modulus of a
+// runtime modint has changed. n must be less than the modulus.
+template <class M> class factorial_table {
+  using usize = std::size_t;
+
+  struct entry {
+    M fact;
+    M inv_fact;
+    M inv;
+  };
+
+  std::vector<entry> t;
+  std::uint_fast64_t key;
+
+  void extend(const usize n) {
+    const std::uint_fast64_t k = (M(0) - M(1)).v;
+    if (k != key) {
+      t.clear();
+      key = k;
+    }
+    if (n < t.size())
+      return;
+    usize old = t.size();
+    t.resize(std::max(n + 1, t.size() * 2));
+    if (old == 0) {
+      t[0] = {M(1), M(1), M(0)};
+      old = 1;
+    }
+    for (usize i = old; i != t.size(); i += 1)
+      t[i].fact = t[i - 1].fact * M(i);
+    t.back().inv_fact = M(1) / t.back().fact;
+    for (usize i = t.size() - 1; i > old; i -= 1)
+      t[i - 1].inv_fact = t[i].inv_fact * M(i);
+    for (usize i = old; i != t.size(); i += 1)
+      t[i].inv = t[i].inv_fact * t[i - 1].fact;
+  }
+
+public:
+  factorial_table() : t(), key(0) {}
+
+  M fact(const usize n) {
+    extend(n);
+    return t[n].fact;
+  }
+  M inv_fact(const usize n) {
+    extend(n);
+    return t[n].inv_fact;
+  }
+  // 1 / n, n >= 1
+  M inv(const usize n) {
+    extend(n);
+    return t[n].inv;
+  }
+  M binom(const usize n, const usize k) {
+    if (k > n)
+      return M(0);
+    extend(n);
+    return t[n].fact * t[k].inv_fact * t[n - k].inv_fact;
+  }
+};
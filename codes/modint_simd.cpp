@@ -0,0 +1,266 @@
+#include "modint.cpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+#include <type_traits>
+
+namespace modint_simd {
+
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+using usize = std::size_t;
+
+// The kernels reinterpret modint<mod> arrays as arrays of u64 holding the
+// value in [0, mod).
+template <u64 mod> constexpr bool layout_check() {
+  static_assert(sizeof(modint<mod>) == sizeof(u64));
+  static_assert(alignof(modint<mod>) == alignof(u64));
+  static_assert(std::is_standard_layout_v<modint<mod>>);
+  static_assert(std::is_trivially_copyable_v<modint<mod>>);
+  return true;
+}
+
+// Montgomery reduction with R = 2^32 on each 64-bit lane.
+template <u64 mod> struct constants {
+  static constexpr bool vectorizable = mod % 2 == 1 && mod < (u64(1) << 31);
+
+  static constexpr u32 get_inv() {
+    u32 ret = mod;
+    for (int i = 0; i != 4; i += 1)
+      ret *= 2 - u32(mod) * ret;
+    return ret;
+  }
+  // -mod^-1 mod 2^32
+  static constexpr u32 neg_inv = -get_inv();
+  // 2^32 mod mod
+  static constexpr u64 r1 = (u64(1) << 32) % mod;
+  // 2^64 mod mod
+  static constexpr u64 r2 = r1 * r1 % mod;
+};
+
+template <u64 mod>
+__attribute__((target("avx2"))) inline __m256i
+reduce_avx2(const __m256i t) {
+  const __m256i m =
+      _mm256_mul_epu32(t, _mm256_set1_epi64x(constants<mod>::neg_inv));
+  const __m256i u = _mm256_mul_epu32(m, _mm256_set1_epi64x(mod));
+  return _mm256_srli_epi64(_mm256_add_epi64(t, u), 32);
+}
+
+// [0, 2 * mod) -> [0, mod)
+template <u64 mod>
+__attribute__((target("avx2"))) inline __m256i
+normalize_avx2(const __m256i x) {
+  const __m256i m = _mm256_cmpgt_epi64(x, _mm256_set1_epi64x(mod - 1));
+  return _mm256_sub_epi64(x, _mm256_and_si256(m, _mm256_set1_epi64x(mod)));
+}
+
+// GCC 12 builds _mm512_set1_epi64 and friends on an undefined vector and
+// reports it under -Wmaybe-uninitialized wherever they are inlined.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+template <u64 mod>
+__attribute__((target("avx512f"))) inline __m512i
+reduce_avx512(const __m512i t) {
+  const __m512i m =
+      _mm512_mul_epu32(t, _mm512_set1_epi64(constants<mod>::neg_inv));
+  const __m512i u = _mm512_mul_epu32(m, _mm512_set1_epi64(mod));
+  return _mm512_srli_epi64(_mm512_add_epi64(t, u), 32);
+}
+
+template <u64 mod>
+__attribute__((target("avx512f"))) inline __m512i
+normalize_avx512(const __m512i x) {
+  return _mm512_min_epu64(x, _mm512_sub_epi64(x, _mm512_set1_epi64(mod)));
+}
+
+// y[i] += a * x[i]
+template <u64 mod>
+__attribute__((target("avx2"))) void
+axpy_avx2(const modint<mod> a, const modint<mod> *x, modint<mod> *y,
+          const usize n) {
+  const __m256i av = _mm256_set1_epi64x(a.v * constants<mod>::r1 % mod);
+  usize i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i xv = _mm256_loadu_si256((const __m256i *)(x + i));
+    const __m256i yv = _mm256_loadu_si256((const __m256i *)(y + i));
+    const __m256i p =
+        normalize_avx2<mod>(reduce_avx2<mod>(_mm256_mul_epu32(av, xv)));
+    _mm256_storeu_si256((__m256i *)(y + i),
+                        normalize_avx2<mod>(_mm256_add_epi64(yv, p)));
+  }
+  for (; i != n; i += 1)
+    y[i] += a * x[i];
+}
+
+template <u64 mod>
+__attribute__((target("avx512f"))) void
+axpy_avx512(const modint<mod> a, const modint<mod> *x, modint<mod> *y,
+            const usize n) {
+  const __m512i av = _mm512_set1_epi64(a.v * constants<mod>::r1 % mod);
+  usize i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m512i xv = _mm512_loadu_si512(x + i);
+    const __m512i yv = _mm512_loadu_si512(y + i);
+    const __m512i p =
+        normalize_avx512<mod>(reduce_avx512<mod>(_mm512_mul_epu32(av, xv)));
+    _mm512_storeu_si512(y + i, normalize_avx512<mod>(_mm512_add_epi64(yv, p)));
+  }
+  for (; i != n; i += 1)
+    y[i] += a * x[i];
+}
+
+// y[i] *= x[i]
+template <u64 mod>
+__attribute__((target("avx2"))) void
+mul_avx2(const modint<mod> *x, modint<mod> *y, const usize n) {
+  const __m256i r2 = _mm256_set1_epi64x(constants<mod>::r2);
+  usize i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i xv = _mm256_loadu_si256((const __m256i *)(x + i));
+    const __m256i yv = _mm256_loadu_si256((const __m256i *)(y + i));
+    const __m256i p = reduce_avx2<mod>(_mm256_mul_epu32(xv, yv));
+    _mm256_storeu_si256(
+        (__m256i *)(y + i),
+        normalize_avx2<mod>(reduce_avx2<mod>(_mm256_mul_epu32(p, r2))));
+  }
+  for (; i != n; i += 1)
+    y[i] *= x[i];
+}
+
+template <u64 mod>
+__attribute__((target("avx512f"))) void
+mul_avx512(const modint<mod> *x, modint<mod> *y, const usize n) {
+  const __m512i r2 = _mm512_set1_epi64(constants<mod>::r2);
+  usize i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m512i xv = _mm512_loadu_si512(x + i);
+    const __m512i yv = _mm512_loadu_si512(y + i);
+    const __m512i p = reduce_avx512<mod>(_mm512_mul_epu32(xv, yv));
+    _mm512_storeu_si512(
+        y + i,
+        normalize_avx512<mod>(reduce_avx512<mod>(_mm512_mul_epu32(p, r2))));
+  }
+  for (; i != n; i += 1)
+    y[i] *= x[i];
+}
+
+// Each lane accumulates x * y * 2^-32 < 2^32 without reduction, which is
+// safe for n < 2^32 per lane.
+template <u64 mod>
+__attribute__((target("avx2"))) modint<mod>
+dot_avx2(const modint<mod> *x, const modint<mod> *y, const usize n) {
+  __m256i acc = _mm256_setzero_si256();
+  usize i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i xv = _mm256_loadu_si256((const __m256i *)(x + i));
+    const __m256i yv = _mm256_loadu_si256((const __m256i *)(y + i));
+    acc = _mm256_add_epi64(acc, reduce_avx2<mod>(_mm256_mul_epu32(xv, yv)));
+  }
+  alignas(32) u64 lane[4];
+  _mm256_store_si256((__m256i *)lane, acc);
+  modint<mod> ret = 0;
+  for (const u64 s : lane)
+    ret += modint<mod>(s);
+  ret *= modint<mod>(constants<mod>::r1);
+  for (; i != n; i += 1)
+    ret += x[i] * y[i];
+  return ret;
+}
+
+template <u64 mod>
+__attribute__((target("avx512f"))) modint<mod>
+dot_avx512(const modint<mod> *x, const modint<mod> *y, const usize n) {
+  __m512i acc = _mm512_setzero_si512();
+  usize i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m512i xv = _mm512_loadu_si512(x + i);
+    const __m512i yv = _mm512_loadu_si512(y + i);
+    acc = _mm512_add_epi64(acc, reduce_avx512<mod>(_mm512_mul_epu32(xv, yv)));
+  }
+  alignas(64) u64 lane[8];
+  _mm512_store_si512(lane, acc);
+  modint<mod> ret = 0;
+  for (const u64 s : lane)
+    ret += modint<mod>(s);
+  ret *= modint<mod>(constants<mod>::r1);
+  for (; i != n; i += 1)
+    ret += x[i] * y[i];
+  return ret;
+}
+
+#pragma GCC diagnostic pop
+
+enum class isa { scalar, avx2, avx512 };
+
+inline isa detect() {
+  static const isa ret = []() {
+    if (__builtin_cpu_supports("avx512f"))
+      return isa::avx512;
+    if (__builtin_cpu_supports("avx2"))
+      return isa::avx2;
+    return isa::scalar;
+  }();
+  return ret;
+}
+
+// y[i] += a * x[i] for i in [0, n)
+template <u64 mod>
+void axpy(const modint<mod> a, const modint<mod> *x, modint<mod> *y,
+          const usize n) {
+  static_assert(layout_check<mod>());
+  if constexpr (constants<mod>::vectorizable) {
+    switch (detect()) {
+    case isa::avx512:
+      return axpy_avx512(a, x, y, n);
+    case isa::avx2:
+      return axpy_avx2(a, x, y, n);
+    case isa::scalar:
+      break;
+    }
+  }
+  for (usize i = 0; i != n; i += 1)
+    y[i] += a * x[i];
+}
+
+// y[i] *= x[i] for i in [0, n)
+template <u64 mod>
+void mul(const modint<mod> *x, modint<mod> *y, const usize n) {
+  static_assert(layout_check<mod>());
+  if constexpr (constants<mod>::vectorizable) {
+    switch (detect()) {
+    case isa::avx512:
+      return mul_avx512(x, y, n);
+    case isa::avx2:
+      return mul_avx2(x, y, n);
+    case isa::scalar:
+      break;
+    }
+  }
+  for (usize i = 0; i != n; i += 1)
+    y[i] *= x[i];
+}
+
+// sum of x[i] * y[i] for i in [0, n), n < 2^32
+template <u64 mod>
+modint<mod> dot(const modint<mod> *x, const modint<mod> *y, const usize n) {
+  static_assert(layout_check<mod>());
+  if constexpr (constants<mod>::vectorizable) {
+    switch (detect()) {
+    case isa::avx512:
+      return dot_avx512(x, y, n);
+    case isa::avx2:
+      return dot_avx2(x, y, n);
+    case isa::scalar:
+      break;
+    }
+  }
+  modint<mod> ret = 0;
+  for (usize i = 0; i != n; i += 1)
+    ret += x[i] * y[i];
+  return ret;
+}
+
+} // namespace modint_simd
@@ -0,0 +1,79 @@
+#include <cstdint>
+
+template <std::uint_fast32_t mod> class montgomery_modint {
+  using u32 = std::uint32_t;
+  using u64 = std::uint64_t;
+
+  static_assert(mod % 2 == 1, "mod must be odd");
+  static_assert(mod < (u32(1) << 31), "mod must be less than 2^31");
+
+  static constexpr u32 get_r() noexcept {
+    u32 ret = mod;
+    for (int i = 0; i != 4; i += 1)
+      ret *= 2 - mod * ret;
+    return ret;
+  }
+  // mod * r == 1 (mod 2^32)
+  static constexpr u32 r = get_r();
+  // 2^64 mod mod
+  static constexpr u32 n2 = -u64(mod) % mod;
+
+  // a < mod * 2^32 -> a * 2^-32 (mod mod), [0, mod)
+  static constexpr u32 reduce(const u64 a) noexcept {
+    const u32 hi = a >> 32;
+    const u32 sub = (u64(u32(a) * r) * mod) >> 32;
+    return hi < sub ? hi - sub + mod : hi - sub;
+  }
+
+public:
+  u32 v;
+
+  constexpr montgomery_modint(const u64 x = 0) noexcept
+      : v(reduce(u64(x % mod) * n2)) {}
+  constexpr u32 val() const noexcept { return reduce(v); }
+  constexpr montgomery_modint operator+(const montgomery_modint rhs) const
+      noexcept {
+    return montgomery_modint(*this) += rhs;
+  }
+  constexpr montgomery_modint operator-(const montgomery_modint rhs) const
+      noexcept {
+    return montgomery_modint(*this) -= rhs;
+  }
+  constexpr montgomery_modint operator*(const montgomery_modint rhs) const
+      noexcept {
+    return montgomery_modint(*this) *= rhs;
+  }
+  constexpr montgomery_modint operator/(const montgomery_modint rhs) const
+      noexcept {
+    return montgomery_modint(*this) /= rhs;
+  }
+  constexpr montgomery_modint &
+  operator+=(const montgomery_modint rhs) noexcept {
+    v += rhs.v;
+    if (v >= mod)
+      v -= mod;
+    return *this;
+  }
+  constexpr montgomery_modint &
+  operator-=(const montgomery_modint rhs) noexcept {
+    if (v < rhs.v)
+      v += mod;
+    v -= rhs.v;
+    return *this;
+  }
+  constexpr montgomery_modint &
+  operator*=(const montgomery_modint rhs) noexcept {
+    v = reduce(u64(v) * rhs.v);
+    return *this;
+  }
+  constexpr montgomery_modint &operator/=(montgomery_modint rhs) noexcept {
+    u64 exp = mod - 2;
+    while (exp != 0) {
+      if (exp % 2 != 0)
+        *this *= rhs;
+      rhs *= rhs;
+      exp /= 2;
+    }
+    return *this;
+  }
+};
@@ -0,0 +1,266 @@
+#include "montgomery_modint.cpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <std::uint_fast32_t mod> class ntt {
+  using u32 = std::uint32_t;
+  using u64 = std::uint64_t;
+  using usize = std::size_t;
+
+public:
+  using mint = montgomery_modint<mod>;
+
+private:
+  static constexpr u64 pow_mod(u64 x, u64 exp) {
+    u64 ret = 1;
+    while (exp != 0) {
+      if (exp % 2 != 0)
+        ret = ret * x % mod;
+      x = x * x % mod;
+      exp /= 2;
+    }
+    return ret;
+  }
+
+  static constexpr u32 primitive_root() {
+    u64 factors[32] = {};
+    usize cnt = 0;
+    u64 m = mod - 1;
+    for (u64 p = 2; p * p <= m; p += 1) {
+      if (m % p == 0) {
+        factors[cnt++] = p;
+        while (m % p == 0)
+          m /= p;
+      }
+    }
+    if (m != 1)
+      factors[cnt++] = m;
+    for (u32 g = 2;; g += 1) {
+      bool ok = true;
+      for (usize i = 0; i != cnt; i += 1)
+        ok = ok && pow_mod(g, (mod - 1) / factors[i]) != 1;
+      if (ok)
+        return g;
+    }
+  }
+
+  static constexpr u32 max_log = __builtin_ctz(mod - 1);
+  static constexpr u32 g = primitive_root();
+
+  // Blocks of this many elements are carried through all remaining layers
+  // before moving on. Must be a power of 4.
+  static constexpr usize block = 1 << 12;
+
+  static constexpr usize naive_threshold = 48;
+
+  // rt[k] = w^rev(k) where w is a primitive 2H-th root of unity, H is the
+  // table size and rev reverses log2(H) bits. The prefix of length h of
+  // this table is the table for h, so one table serves every size.
+  struct tables {
+    std::vector<mint> rt, irt;
+    std::vector<mint> scratch;
+
+    tables() : rt(1, mint(1)), irt(1, mint(1)), scratch() {}
+  };
+
+  static tables &get() {
+    static thread_local tables t;
+    return t;
+  }
+
+  static void reserve(const usize n) {
+    tables &t = get();
+    while (t.rt.size() * 2 < n) {
+      const usize s = t.rt.size();
+      const u32 lg = __builtin_ctzll(s) + 2;
+      const mint w = pow_mod(g, (mod - 1) >> lg);
+      const mint iw = mint(1) / w;
+      t.rt.resize(2 * s);
+      t.irt.resize(2 * s);
+      for (usize j = 0; j != s; j += 1) {
+        t.rt[s + j] = t.rt[j] * w;
+        t.irt[s + j] = t.irt[j] * iw;
+      }
+    }
+  }
+
+  static usize first_radix4(const usize n) {
+    usize m = __builtin_ctzll(n) % 2 == 1 ? n / 2 : n;
+    while (m > block)
+      m /= 4;
+    return m;
+  }
+
+  static void forward_pass(mint *const a, const usize begin, const usize end,
+                           const usize m, const mint *const rt) {
+    const usize q = m / 4;
+    const mint imag = rt[1];
+    for (usize s = begin, k = begin / m; s != end; s += m, k += 1) {
+      const mint w1 = rt[2 * k];
+      const mint w2 = w1 * w1;
+      const mint w3 = w2 * w1;
+      for (usize i = s; i != s + q; i += 1) {
+        const mint a0 = a[i];
+        const mint a1 = a[i + q] * w1;
+        const mint a2 = a[i + 2 * q] * w2;
+        const mint a3 = a[i + 3 * q] * w3;
+        const mint t0 = a0 + a2;
+        const mint t1 = a0 - a2;
+        const mint t2 = a1 + a3;
+        const mint t3 = (a1 - a3) * imag;
+        a[i] = t0 + t2;
+        a[i + q] = t0 - t2;
+        a[i + 2 * q] = t1 + t3;
+        a[i + 3 * q] = t1 - t3;
+      }
+    }
+  }
+
+  static void inverse_pass(mint *const a, const usize begin, const usize end,
+                           const usize m, const mint *const irt) {
+    const usize q = m / 4;
+    const mint iimag = irt[1];
+    for (usize s = begin, k = begin / m; s != end; s += m, k += 1) {
+      const mint w1 = irt[2 * k];
+      const mint w2 = w1 * w1;
+      const mint w3 = w2 * w1;
+      for (usize i = s; i != s + q; i += 1) {
+        const mint z0 = a[i];
+        const mint z1 = a[i + q];
+        const mint z2 = a[i + 2 * q];
+        const mint z3 = a[i + 3 * q];
+        const mint s02 = z0 + z1;
+        const mint s13 = z0 - z1;
+        const mint d02 = z2 + z3;
+        const mint d13 = (z2 - z3) * iimag;
+        a[i] = s02 + d02;
+        a[i + q] = (s13 + d13) * w1;
+        a[i + 2 * q] = (s02 - d02) * w2;
+        a[i + 3 * q] = (s13 - d13) * w3;
+      }
+    }
+  }
+
+  template <class A, class B>
+  static std::vector<mint, A> naive(const std::vector<mint, A> &l,
+                                    const std::vector<mint, B> &r) {
+    std::vector<mint, A> ret(l.size() + r.size() - 1, mint(0),
+                             l.get_allocator());
+    for (usize i = 0; i != l.size(); i += 1)
+      for (usize j = 0; j != r.size(); j += 1)
+        ret[i + j] += l[i] * r[j];
+    return ret;
+  }
+
+public:
+  // n is a power of two, n <= 2^max_log. The result is in bit-reversed
+  // order, which inverse() expects.
+  static void forward(mint *const a, const usize n) {
+    if (n == 1)
+      return;
+    reserve(n);
+    const mint *const rt = get().rt.data();
+    if (__builtin_ctzll(n) % 2 == 1) {
+      const usize h = n / 2;
+      for (usize i = 0; i != h; i += 1) {
+        const mint x = a[i];
+        const mint y = a[i + h];
+        a[i] = x + y;
+        a[i + h] = x - y;
+      }
+    }
+    usize m = __builtin_ctzll(n) % 2 == 1 ? n / 2 : n;
+    const usize c = first_radix4(n);
+    for (; m > c; m /= 4)
+      forward_pass(a, 0, n, m, rt);
+    for (usize s = 0; s != n; s += c)
+      for (usize mm = c; mm >= 4; mm /= 4)
+        forward_pass(a, s, s + c, mm, rt);
+  }
+
+  // Includes the division by n.
+  static void inverse(mint *const a, const usize n) {
+    if (n == 1)
+      return;
+    reserve(n);
+    const mint *const irt = get().irt.data();
+    const usize c = first_radix4(n);
+    for (usize s = 0; s != n; s += c)
+      for (usize mm = 4; mm <= c; mm *= 4)
+        inverse_pass(a, s, s + c, mm, irt);
+    const usize top = __builtin_ctzll(n) % 2 == 1 ? n / 2 : n;
+    for (usize m = c * 4; m <= top; m *= 4)
+      inverse_pass(a, 0, n, m, irt);
+    if (top != n) {
+      const usize h = n / 2;
+      for (usize i = 0; i != h; i += 1) {
+        const mint x = a[i];
+        const mint y = a[i + h];
+        a[i] = x + y;
+        a[i + h] = x - y;
+      }
+    }
+    const mint inv_n = mint(1) / mint(n);
+    for (usize i = 0; i != n; i += 1)
+      a[i] *= inv_n;
+  }
+
+  // Multiplies a transformed polynomial by x^d (mod x^n - 1). Index j of
+  // the transform is the value at rt[j / 2] for even j and -rt[j / 2] for
+  // odd j.
+  static void shift(mint *const a, const usize n, const usize d = 1) {
+    if (n == 1 || d == 0)
+      return;
+    reserve(n);
+    const mint *const rt = get().rt.data();
+    for (usize j = 0; j != n; j += 2) {
+      mint w = rt[j / 2];
+      if (d != 1) {
+        mint base = w;
+        w = mint(1);
+        for (usize e = d; e != 0; e /= 2) {
+          if (e % 2 != 0)
+            w *= base;
+          base *= base;
+        }
+      }
+      a[j] *= w;
+      a[j + 1] *= d % 2 == 0 ? w : mint(0) - w;
+    }
+  }
+
+  static usize transform_size(const usize len) {
+    usize n = 1;
+    while (n < len)
+      n *= 2;
+    return n;
+  }
+
+  // l's storage is reused for the result, r goes through a per-thread
+  // scratch buffer.
+  template <class A, class B>
+  static std::vector<mint, A> multiply(std::vector<mint, A> l,
+                                       const std::vector<mint, B> &r) {
+    if (l.empty() || r.empty())
+      return {};
+    if (std::min(l.size(), r.size()) <= naive_threshold)
+      return naive(l, r);
+    const usize len = l.size() + r.size() - 1;
+    const usize n = transform_size(len);
+    std::vector<mint> &b = get().scratch;
+    b.assign(n, mint(0));
+    std::copy(r.begin(), r.end(), b.begin());
+    l.resize(n, mint(0));
+    forward(l.data(), n);
+    forward(b.data(), n);
+    for (usize i = 0; i != n; i += 1)
+      l[i] *= b[i];
+    inverse(l.data(), n);
+    l.resize(len);
+    return l;
+  }
+};
@@ -0,0 +1,302 @@
+#include "rerooting.cpp"
+#include "rerooting_csr.cpp"
+#include "rerooting_dynamic.cpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Usage: rerooting_benchmark [N] [threads] [K]
+// Builds both ReRooting variants, and CsrReRooting once more with threads, on
+// a random tree with shuffled labels and compares construction time and
+// results. DynamicReRooting and LinkCutReRooting are built and then queried at
+// every vertex in random order, then both cut and relink random edges and are
+// queried alternately at the two ends of a path of N vertices. Both are also
+// checked against ReRooting rebuilt after every random vertex update and
+// cut / link on a small tree whose DP is a product of 2x2 matrices, which
+// depends on the order of the edges. K weighted
+// variants of the DP are then computed one by one and with
+// BatchedCsrReRooting. The DP is the eccentricity of every vertex.
+
+template <class F> double time_ms(F f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char **argv) {
+  const int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  const int threads =
+      argc > 2 ? std::atoi(argv[2])
+               : std::max(2u, std::thread::hardware_concurrency());
+  const int k_count = argc > 3 ? std::atoi(argv[3]) : 16;
+
+  std::mt19937 rng(91);
+  std::vector<int> label(n);
+  std::iota(label.begin(), label.end(), 0);
+  std::shuffle(label.begin(), label.end(), rng);
+  std::vector<std::array<int, 2>> edges(n - 1);
+  for (int v = 1; v < n; v += 1) {
+    edges[v - 1] = {label[rng() % v], label[v]};
+  }
+  std::shuffle(edges.begin(), edges.end(), rng);
+
+  const auto operate = [](const int l, const int r) { return std::max(l, r); };
+  const auto operate_node = [](const int x, int) { return x + 1; };
+
+  std::vector<int> csr_res(n);
+  const double csr_ms = time_ms([&]() {
+    CsrReRooting rr(n, edges, -1, operate, operate_node);
+    for (int v = 0; v < n; v += 1) {
+      csr_res[v] = rr.Query(v);
+    }
+  });
+  std::printf("CsrReRooting %10.1f ms\n", csr_ms);
+
+  std::vector<int> parallel_res(n);
+  const double parallel_ms = time_ms([&]() {
+    CsrReRooting rr(n, edges, -1, operate, operate_node, threads);
+    for (int v = 0; v < n; v += 1) {
+      parallel_res[v] = rr.Query(v);
+    }
+  });
+  std::printf("  %2d threads %10.1f ms\n", threads, parallel_ms);
+
+  std::vector<int> dynamic_res(n);
+  std::vector<int> query_order(n);
+  std::iota(query_order.begin(), query_order.end(), 0);
+  std::shuffle(query_order.begin(), query_order.end(), rng);
+  const double dynamic_ms = time_ms([&]() {
+    DynamicReRooting rr(n, edges, -1, operate, operate_node);
+    for (const int v : query_order) {
+      dynamic_res[v] = rr.Query(v);
+    }
+  });
+  std::printf("DynamicReRooting %6.1f ms\n", dynamic_ms);
+
+  // x -> max(f[0], x + f[1])
+  using ecc = std::array<int, 2>;
+  const auto lift = [](const int l, const int r, int) {
+    return ecc{std::max(l, r) + 1, 1};
+  };
+  const auto compose = [](const ecc &f, const ecc &g) {
+    return ecc{std::max(f[0], g[0] + f[1]), f[1] + g[1]};
+  };
+  const auto apply = [](const ecc &f, const int x) {
+    return std::max(f[0], x + f[1]);
+  };
+
+  std::vector<int> link_cut_res(n);
+  const double link_cut_ms = time_ms([&]() {
+    LinkCutReRooting rr(n, edges, -1, operate, lift, compose, apply);
+    for (const int v : query_order) {
+      link_cut_res[v] = rr.Query(v);
+    }
+  });
+  std::printf("LinkCutReRooting %6.1f ms\n", link_cut_ms);
+
+  {
+    DynamicReRooting dynamic(n, edges, -1, operate, operate_node);
+    LinkCutReRooting link_cut(n, edges, -1, operate, lift, compose, apply);
+    for (int i = 0; i < 1000; i += 1) {
+      const auto [u, v] = edges[rng() % (n - 1)];
+      dynamic.Cut(u, v);
+      link_cut.Cut(u, v);
+      const bool same = dynamic.Query(u) == link_cut.Query(u) &&
+                        dynamic.Query(v) == link_cut.Query(v);
+      dynamic.Link(u, v);
+      link_cut.Link(u, v);
+      if (!same || dynamic.Query(u) != link_cut.Query(u)) {
+        std::printf("cut / link results differ\n");
+        return 1;
+      }
+    }
+  }
+
+  {
+    // Products of 2x2 matrices mod p. The DP at v is the product over its
+    // neighbours in edge order, times w[v].
+    using mat = std::array<unsigned, 4>;
+    const auto mul = [](const mat &a, const mat &b) {
+      const auto dot = [](unsigned x, unsigned y, unsigned z, unsigned t) {
+        const unsigned long long p = 998244353;
+        return unsigned((1ull * x * y % p + 1ull * z * t % p) % p);
+      };
+      return mat{dot(a[0], b[0], a[1], b[2]), dot(a[0], b[1], a[1], b[3]),
+                 dot(a[2], b[0], a[3], b[2]), dot(a[2], b[1], a[3], b[3])};
+    };
+    const mat unit = {1, 0, 0, 1};
+    const int m = std::min(n, 300);
+    std::vector<mat> w(m);
+    for (mat &a : w) {
+      a = {unsigned(rng() % 998244353), unsigned(rng() % 998244353),
+           unsigned(rng() % 998244353), unsigned(rng() % 998244353)};
+    }
+    const auto times_w = [&](const mat &x, const int v) {
+      return mul(x, w[v]);
+    };
+    // x -> f[0] * x * f[1]
+    using pair = std::array<mat, 2>;
+    const auto mat_lift = [&](const mat &l, const mat &r, const int v) {
+      return pair{l, mul(r, w[v])};
+    };
+    const auto mat_compose = [&](const pair &f, const pair &g) {
+      return pair{mul(f[0], g[0]), mul(g[1], f[1])};
+    };
+    const auto mat_apply = [&](const pair &f, const mat &x) {
+      return mul(mul(f[0], x), f[1]);
+    };
+    std::vector<std::array<int, 2>> tree(m - 1);
+    for (int v = 1; v < m; v += 1) {
+      tree[v - 1] = {int(rng() % v), v};
+    }
+    DynamicReRooting dynamic(m, tree, unit, mul, times_w);
+    LinkCutReRooting link_cut(m, tree, unit, mul, mat_lift, mat_compose,
+                              mat_apply);
+    std::vector<int> seen(m);
+    for (int i = 0; i < 300; i += 1) {
+      if (i % 2 == 0) {
+        const int v = rng() % m;
+        w[v] = {unsigned(rng() % 998244353), unsigned(rng() % 998244353),
+                unsigned(rng() % 998244353), unsigned(rng() % 998244353)};
+        dynamic.Update(v);
+        link_cut.Update(v);
+      } else if (m > 1) {
+        // Replace a random edge with one between the two components.
+        const int j = rng() % (m - 1);
+        const auto [u, v] = tree[j];
+        tree.erase(tree.begin() + j);
+        dynamic.Cut(u, v);
+        link_cut.Cut(u, v);
+        std::vector<std::vector<int>> adjacent(m);
+        for (const auto &[a, b] : tree) {
+          adjacent[a].push_back(b);
+          adjacent[b].push_back(a);
+        }
+        std::fill(seen.begin(), seen.end(), 0);
+        std::vector<int> stack = {u}, inside, outside;
+        seen[u] = 1;
+        while (!stack.empty()) {
+          const int x = stack.back();
+          stack.pop_back();
+          inside.push_back(x);
+          for (const int y : adjacent[x]) {
+            if (!seen[y]) {
+              seen[y] = 1;
+              stack.push_back(y);
+            }
+          }
+        }
+        for (int x = 0; x < m; x += 1) {
+          if (!seen[x]) {
+            outside.push_back(x);
+          }
+        }
+        const int a = inside[rng() % inside.size()];
+        const int b = outside[rng() % outside.size()];
+        tree.push_back({a, b});
+        dynamic.Link(a, b);
+        link_cut.Link(a, b);
+      }
+      std::vector<std::vector<int>> e(tree.size());
+      for (std::size_t j = 0; j < tree.size(); j += 1) {
+        e[j] = {tree[j][0], tree[j][1]};
+      }
+      ReRooting<mat> rr(m, std::move(e), unit, mul, times_w);
+      for (int v = 0; v < m; v += 1) {
+        if (dynamic.Query(v) != rr.Query(v) ||
+            link_cut.Query(v) != rr.Query(v)) {
+          std::printf("update / cut / link results differ\n");
+          return 1;
+        }
+      }
+    }
+  }
+
+  std::vector<std::array<int, 2>> path(n - 1);
+  for (int v = 1; v < n; v += 1) {
+    path[v - 1] = {v - 1, v};
+  }
+  const int ends = 100;
+  long long dynamic_sum = 0, link_cut_sum = 0;
+  const double dynamic_path_ms = time_ms([&]() {
+    DynamicReRooting rr(n, path, -1, operate, operate_node);
+    for (int i = 0; i < ends; i += 1) {
+      dynamic_sum += rr.Query(i % 2 == 0 ? 0 : n - 1);
+    }
+  });
+  const double link_cut_path_ms = time_ms([&]() {
+    LinkCutReRooting rr(n, path, -1, operate, lift, compose, apply);
+    for (int i = 0; i < ends; i += 1) {
+      link_cut_sum += rr.Query(i % 2 == 0 ? 0 : n - 1);
+    }
+  });
+  std::printf("path ends x %d: DynamicReRooting %.1f ms, "
+              "LinkCutReRooting %.1f ms\n",
+              ends, dynamic_path_ms, link_cut_path_ms);
+  if (dynamic_sum != link_cut_sum ||
+      dynamic_sum != (long long)(n - 1) * ends) {
+    std::printf("path results differ\n");
+    return 1;
+  }
+
+  std::vector<std::vector<int>> e(n - 1);
+  for (int i = 0; i < n - 1; i += 1) {
+    e[i] = {edges[i][0], edges[i][1]};
+  }
+  std::vector<int> res(n);
+  const double ms = time_ms([&]() {
+    ReRooting<int> rr(n, std::move(e), -1, operate, operate_node);
+    for (int v = 0; v < n; v += 1) {
+      res[v] = rr.Query(v);
+    }
+  });
+  std::printf("ReRooting    %10.1f ms\n", ms);
+
+  if (res != csr_res || res != parallel_res || res != dynamic_res ||
+      res != link_cut_res) {
+    std::printf("results differ\n");
+    return 1;
+  }
+  std::printf("speedup      %10.2fx\n", ms / csr_ms);
+
+  // Instance k adds k % 4 + 1 per edge.
+  std::vector<int> separate_res(std::size_t(n) * k_count);
+  const double separate_ms = time_ms([&]() {
+    for (int k = 0; k < k_count; k += 1) {
+      CsrReRooting rr(n, edges, -1, operate,
+                      [k](const int x, int) { return x + k % 4 + 1; });
+      for (int v = 0; v < n; v += 1) {
+        separate_res[std::size_t(v) * k_count + k] = rr.Query(v);
+      }
+    }
+  });
+  std::printf("%2d x CsrReRooting %6.1f ms\n", k_count, separate_ms);
+
+  std::vector<int> batched_res(std::size_t(n) * k_count);
+  const double batched_ms = time_ms([&]() {
+    const CsrTree tree(n, edges);
+    BatchedCsrReRooting rr(
+        tree, std::vector<int>(k_count, -1),
+        [](const int l, const int r, int) { return std::max(l, r); },
+        [](const int x, int, const int k) { return x + k % 4 + 1; });
+    for (int v = 0; v < n; v += 1) {
+      std::copy(rr.Query(v), rr.Query(v) + k_count,
+                batched_res.begin() + std::size_t(v) * k_count);
+    }
+  });
+  std::printf("BatchedCsrReRooting %5.1f ms\n", batched_ms);
+  if (batched_res != separate_res) {
+    std::printf("batched results differ\n");
+    return 1;
+  }
+  std::printf("speedup      %10.2fx\n", separate_ms / batched_ms);
+  return 0;
+}
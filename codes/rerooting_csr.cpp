@@ -0,0 +1,356 @@
+/*
+rerooting.cpp の ReRooting を
+隣接リストを CSR 形式の配列に、演算を関数オブジェクトのテンプレート引数に
+置き換えたものです
+*/
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 辺 i の両端 (u, v) から作る木の CSR 表現
+// 頂点 v の隣接頂点は Adjacent[Start[v]] .. Adjacent[Start[v + 1] - 1] で、
+// 並びは辺を与えた順です
+class CsrTree {
+public:
+    int NodeCount;
+    int MaxDegree;
+    std::vector<int> Start;
+    std::vector<int> Adjacent;
+    // 半辺 e の逆向きの半辺
+    std::vector<int> Reverse;
+    // 頂点 0 を根とする BFS 順
+    std::vector<int> Order;
+    // 頂点 v から親へ向かう半辺、根は -1
+    std::vector<int> ParentEdge;
+
+    CsrTree() : NodeCount(0), MaxDegree(0) {}
+
+    // edges の要素 edge は edge[0], edge[1] で両端を返すもの
+    template <class EdgeRange>
+    CsrTree(int nodeCount, const EdgeRange &edges)
+        : NodeCount(nodeCount), MaxDegree(0), Start(nodeCount + 1, 0) {
+        for (const auto &edge : edges) {
+            Start[edge[0] + 1]++;
+            Start[edge[1] + 1]++;
+        }
+        for (int i = 0; i < nodeCount; i++) {
+            MaxDegree = std::max(MaxDegree, Start[i + 1]);
+            Start[i + 1] += Start[i];
+        }
+
+        Adjacent.resize(Start[nodeCount]);
+        Reverse.resize(Start[nodeCount]);
+        std::vector<int> position(Start.begin(), Start.end() - 1);
+        for (const auto &edge : edges) {
+            int a = position[edge[0]]++;
+            int b = position[edge[1]]++;
+            Adjacent[a] = edge[1];
+            Adjacent[b] = edge[0];
+            Reverse[a] = b;
+            Reverse[b] = a;
+        }
+        position = std::vector<int>();
+
+        Order.reserve(nodeCount);
+        ParentEdge.assign(nodeCount, -1);
+        if (nodeCount > 0)
+            Order.push_back(0);
+        for (int i = 0; i < Order.size(); i++) {
+            int node = Order[i];
+            for (int e = Start[node]; e < Start[node + 1]; e++) {
+                if (e == ParentEdge[node])
+                    continue;
+                ParentEdge[Adjacent[e]] = Reverse[e];
+                Order.push_back(Adjacent[e]);
+            }
+        }
+    }
+
+    int Degree(int node) const { return Start[node + 1] - Start[node]; }
+};
+
+// Operate(T, T) -> T, OperateNode(T, int) -> T
+// threads > 1 のとき Initialize を複数スレッドで行います
+// Operate, OperateNode は複数スレッドから同時に呼ばれます
+// 結果は threads によらず同じです
+template <class T, class Op, class OpNode> class CsrReRooting {
+public:
+    int NodeCount;
+
+private:
+    CsrTree Tree;
+
+    std::vector<T> Res;
+    // 半辺 e = (v, u) について、v から見た u 側の部分木の値
+    std::vector<T> DP;
+    std::vector<T> Scratch;
+
+    T Identity;
+    Op Operate;
+    OpNode OperateNode;
+
+public:
+    template <class EdgeRange>
+    CsrReRooting(int nodeCount, const EdgeRange &edges, T identity,
+                 Op operate, OpNode operateNode, int threads = 1)
+        : CsrReRooting(CsrTree(nodeCount, edges), std::move(identity),
+                       std::move(operate), std::move(operateNode), threads) {}
+
+    CsrReRooting(CsrTree tree, T identity, Op operate, OpNode operateNode,
+                 int threads = 1)
+        : NodeCount(tree.NodeCount), Tree(std::move(tree)),
+          Res(NodeCount), DP(Tree.Adjacent.size()), Scratch(Tree.MaxDegree),
+          Identity(std::move(identity)), Operate(std::move(operate)),
+          OperateNode(std::move(operateNode)) {
+        if (NodeCount > 1 && threads > 1)
+            InitializeParallel(threads);
+        else if (NodeCount > 1)
+            Initialize();
+        else if (NodeCount == 1)
+            Res[0] = OperateNode(Identity, 0);
+        Scratch = std::vector<T>();
+    }
+
+    const T &Query(int node) const { return Res[node]; }
+
+    const CsrTree &GetTree() const { return Tree; }
+
+private:
+    // この数より小さい部分木は分割しません
+    static constexpr int Grain = 1 << 14;
+
+    void FromLeaf(int node) {
+        int up = Tree.ParentEdge[node];
+        int first = Tree.Start[node];
+        int last = Tree.Start[node + 1];
+        const T *dp = DP.data();
+        T accum = Identity;
+        for (int e = first; e < last; e++) {
+            if (e == up)
+                continue;
+            accum = Operate(accum, dp[e]);
+        }
+        DP[Tree.Reverse[up]] = OperateNode(accum, node);
+    }
+
+    void ToLeaf(int node, T *accumsFromTail) {
+        int first = Tree.Start[node];
+        int degree = Tree.Start[node + 1] - first;
+        const int *reverse = Tree.Reverse.data() + first;
+        T *dp = DP.data();
+
+        accumsFromTail[degree - 1] = Identity;
+        for (int j = degree - 1; j >= 1; j--)
+            accumsFromTail[j - 1] = Operate(dp[first + j], accumsFromTail[j]);
+        T accum = Identity;
+        for (int j = 0; j < degree; j++) {
+            dp[reverse[j]] =
+                OperateNode(Operate(accum, accumsFromTail[j]), node);
+            accum = Operate(accum, dp[first + j]);
+        }
+        Res[node] = OperateNode(accum, node);
+    }
+
+    void Initialize() {
+        for (int i = NodeCount - 1; i >= 1; i--)
+            FromLeaf(Tree.Order[i]);
+        for (int i = 0; i < NodeCount; i++)
+            ToLeaf(Tree.Order[i], Scratch.data());
+    }
+
+    // 大きさ target 以下で極大な部分木をスレッドに割り当て、各スレッドは
+    // 担当する頂点を BFS 順に処理します
+    // 残りの頂点 (部分木が大きすぎるもの) は呼び出したスレッドで処理します
+    void InitializeParallel(int threads) {
+        std::vector<int> owner(NodeCount, 1);
+        for (int i = NodeCount - 1; i >= 1; i--) {
+            int node = Tree.Order[i];
+            owner[Tree.Adjacent[Tree.ParentEdge[node]]] += owner[node];
+        }
+
+        // owner を部分木の大きさから担当する部分木の番号 (なければ -1) に
+        // 書き換えます
+        int target = std::max(Grain, NodeCount / (threads * 8));
+        std::vector<int> top;
+        std::vector<int> subtreeSize;
+        for (int i = 0; i < NodeCount; i++) {
+            int node = Tree.Order[i];
+            int parentOwner =
+                i == 0 ? -1 : owner[Tree.Adjacent[Tree.ParentEdge[node]]];
+            if (parentOwner != -1) {
+                owner[node] = parentOwner;
+            } else if (owner[node] <= target) {
+                subtreeSize.push_back(owner[node]);
+                owner[node] = subtreeSize.size() - 1;
+            } else {
+                top.push_back(node);
+                owner[node] = -1;
+            }
+        }
+
+        // 部分木を頂点数がほぼ等しい threads 個の連続した組に分けます
+        std::vector<int> threadOf(subtreeSize.size());
+        {
+            long long total = NodeCount - top.size();
+            long long accum = 0;
+            for (int k = 0; k < subtreeSize.size(); k++) {
+                threadOf[k] = accum * threads / total;
+                accum += subtreeSize[k];
+            }
+        }
+        std::vector<int> begin(threads + 1, 0);
+        for (int k = 0; k < subtreeSize.size(); k++)
+            begin[threadOf[k] + 1] += subtreeSize[k];
+        for (int t = 0; t < threads; t++)
+            begin[t + 1] += begin[t];
+        std::vector<int> order(NodeCount - top.size());
+        {
+            std::vector<int> position(begin.begin(), begin.end() - 1);
+            for (int i = 0; i < NodeCount; i++) {
+                int node = Tree.Order[i];
+                if (owner[node] != -1)
+                    order[position[threadOf[owner[node]]]++] = node;
+            }
+        }
+        owner = std::vector<int>();
+
+        auto forEachThread = [&](auto work) {
+            std::vector<std::thread> workers;
+            for (int t = 1; t < threads; t++)
+                workers.emplace_back(work, t);
+            work(0);
+            for (auto &worker : workers)
+                worker.join();
+        };
+
+#pragma region fromLeaf
+        forEachThread([&](int t) {
+            for (int i = begin[t + 1] - 1; i >= begin[t]; i--)
+                if (order[i] != 0)
+                    FromLeaf(order[i]);
+        });
+        for (int i = top.size() - 1; i >= 1; i--)
+            FromLeaf(top[i]);
+#pragma endregion
+
+#pragma region toLeaf
+        for (int i = 0; i < top.size(); i++)
+            ToLeaf(top[i], Scratch.data());
+        forEachThread([&](int t) {
+            std::vector<T> accumsFromTail(Tree.MaxDegree);
+            for (int i = begin[t]; i < begin[t + 1]; i++)
+                ToLeaf(order[i], accumsFromTail.data());
+        });
+#pragma endregion
+    }
+};
+
+// 同じ木の上の K 個の DP をまとめて計算します
+// 値は (半辺または頂点) * K + インスタンス の順に並べ、内側のループが
+// インスタンスを走るようにしています
+// Operate(T, T, int k) -> T, OperateNode(T, int node, int k) -> T で、
+// k はインスタンスの番号です
+// tree はこのオブジェクトより長く生存する必要があります
+template <class T, class Op, class OpNode> class BatchedCsrReRooting {
+public:
+    int NodeCount;
+    int K;
+
+private:
+    const CsrTree *Tree;
+
+    std::vector<T> Res;
+    std::vector<T> DP;
+
+    std::vector<T> Identity;
+    Op Operate;
+    OpNode OperateNode;
+
+public:
+    BatchedCsrReRooting(const CsrTree &tree, std::vector<T> identities,
+                        Op operate, OpNode operateNode)
+        : NodeCount(tree.NodeCount), K(identities.size()), Tree(&tree),
+          Res((long long)NodeCount * K), DP(tree.Adjacent.size() * K),
+          Identity(std::move(identities)), Operate(std::move(operate)),
+          OperateNode(std::move(operateNode)) {
+        if (NodeCount > 1)
+            Initialize();
+        else if (NodeCount == 1)
+            for (int k = 0; k < K; k++)
+                Res[k] = OperateNode(Identity[k], 0, k);
+    }
+
+    const T &Query(int node, int k) const {
+        return Res[(long long)node * K + k];
+    }
+
+    // インスタンス 0 .. K - 1 の値が連続して並んでいます
+    const T *Query(int node) const { return Res.data() + (long long)node * K; }
+
+private:
+    void Initialize() {
+        const int *start = Tree->Start.data();
+        const int *reverse = Tree->Reverse.data();
+        const int *parentEdge = Tree->ParentEdge.data();
+        const T *identity = Identity.data();
+        T *dp = DP.data();
+        std::vector<T> accum(K);
+        std::vector<T> accumsFromTail((long long)Tree->MaxDegree * K);
+
+#pragma region fromLeaf
+        for (int i = NodeCount - 1; i >= 1; i--) {
+            int node = Tree->Order[i];
+            int up = parentEdge[node];
+
+            for (int k = 0; k < K; k++)
+                accum[k] = identity[k];
+            for (int e = start[node]; e < start[node + 1]; e++) {
+                if (e == up)
+                    continue;
+                const T *child = dp + (long long)e * K;
+                for (int k = 0; k < K; k++)
+                    accum[k] = Operate(accum[k], child[k], k);
+            }
+            T *out = dp + (long long)reverse[up] * K;
+            for (int k = 0; k < K; k++)
+                out[k] = OperateNode(accum[k], node, k);
+        }
+#pragma endregion
+
+#pragma region toLeaf
+        for (int i = 0; i < NodeCount; i++) {
+            int node = Tree->Order[i];
+            int first = start[node];
+            int degree = start[node + 1] - first;
+
+            T *tail = accumsFromTail.data();
+            for (int k = 0; k < K; k++)
+                tail[(long long)(degree - 1) * K + k] = identity[k];
+            for (int j = degree - 1; j >= 1; j--) {
+                const T *value = dp + (long long)(first + j) * K;
+                const T *from = tail + (long long)j * K;
+                T *to = tail + (long long)(j - 1) * K;
+                for (int k = 0; k < K; k++)
+                    to[k] = Operate(value[k], from[k], k);
+            }
+            for (int k = 0; k < K; k++)
+                accum[k] = identity[k];
+            for (int j = 0; j < degree; j++) {
+                T *out = dp + (long long)reverse[first + j] * K;
+                const T *from = tail + (long long)j * K;
+                for (int k = 0; k < K; k++)
+                    out[k] =
+                        OperateNode(Operate(accum[k], from[k], k), node, k);
+                const T *value = dp + (long long)(first + j) * K;
+                for (int k = 0; k < K; k++)
+                    accum[k] = Operate(accum[k], value[k], k);
+            }
+            T *res = Res.data() + (long long)node * K;
+            for (int k = 0; k < K; k++)
+                res[k] = OperateNode(accum[k], node, k);
+        }
+#pragma endregion
+    }
+};
@@ -0,0 +1,604 @@
+/*
+rerooting.cpp の ReRooting に、OperateNode の頂点ごとの値の変更と
+辺の追加・削除を加えたものです
+
+DynamicReRooting は ReRooting と同じ Operate と OperateNode だけで動きます
+根を最後に Query / Update した頂点に置き、各頂点は隣接頂点側の値を
+辺の順に並べたセグメント木で持ちます
+操作する頂点まで根を 1 辺ずつ動かすので、1 回の操作は
+O(直前の根からの距離 * log 次数) で、最悪 O(N) です
+Operate と OperateNode の組からは頂点の関数の合成が表せないため、
+このインターフェースでは多重対数時間にできません
+
+LinkCutReRooting は頂点の関数
+x -> OperateNode(Operate(Operate(l, x), r), v) を表す型とその合成を
+追加で受け取り、link-cut tree の上で 1 回の操作をならし
+O(log N * log 次数) で行います
+どちらも Operate が可換である必要はなく、隣接頂点の値は辺を追加した順に
+畳み込みます
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Operate(T, T) -> T, OperateNode(T, int) -> T
+// Identity は Operate の単位元である必要があります
+template <class T, class Op, class OpNode> class DynamicReRooting {
+public:
+    int NodeCount;
+
+private:
+    struct Node {
+        // 辺を追加した順で、削除した辺は -1
+        std::vector<int> Adjacent;
+        // Adjacent[i] の隣接リストでこの頂点がある位置
+        std::vector<int> IndexForAdjacent;
+        // 葉は Capacity + i、親と削除した辺の位置は Identity
+        std::vector<T> Seg;
+        int Capacity;
+        int Removed;
+        // 親の位置、根は -1
+        int ParentIndex;
+    };
+
+    std::vector<Node> Nodes;
+    std::vector<int> Path;
+
+    T Identity;
+    Op Operate;
+    OpNode OperateNode;
+
+public:
+    template <class EdgeRange>
+    DynamicReRooting(int nodeCount, const EdgeRange &edges, T identity,
+                     Op operate, OpNode operateNode)
+        : NodeCount(nodeCount), Nodes(nodeCount),
+          Identity(std::move(identity)), Operate(std::move(operate)),
+          OperateNode(std::move(operateNode)) {
+        for (const auto &edge : edges) {
+            Node &u = Nodes[edge[0]];
+            Node &v = Nodes[edge[1]];
+            u.IndexForAdjacent.push_back(v.Adjacent.size());
+            v.IndexForAdjacent.push_back(u.Adjacent.size());
+            u.Adjacent.push_back(edge[1]);
+            v.Adjacent.push_back(edge[0]);
+        }
+
+        std::vector<int> order;
+        order.reserve(nodeCount);
+        for (int i = 0; i < nodeCount; i++) {
+            Node &node = Nodes[i];
+            node.Capacity = 1;
+            while (node.Capacity < node.Adjacent.size())
+                node.Capacity *= 2;
+            node.Seg.assign(node.Capacity * 2, Identity);
+            node.Removed = 0;
+            node.ParentIndex = -2;
+        }
+        // 森でもよく、各連結成分の最小の頂点を根にします
+        for (int root = 0; root < nodeCount; root++) {
+            if (Nodes[root].ParentIndex != -2)
+                continue;
+            Nodes[root].ParentIndex = -1;
+            int head = order.size();
+            order.push_back(root);
+            for (int i = head; i < order.size(); i++) {
+                Node &node = Nodes[order[i]];
+                for (int j = 0; j < node.Adjacent.size(); j++) {
+                    if (j == node.ParentIndex)
+                        continue;
+                    Nodes[node.Adjacent[j]].ParentIndex =
+                        node.IndexForAdjacent[j];
+                    order.push_back(node.Adjacent[j]);
+                }
+            }
+        }
+        for (int i = nodeCount - 1; i >= 0; i--) {
+            int index = order[i];
+            Node &node = Nodes[index];
+            for (int j = node.Capacity - 1; j >= 1; j--)
+                node.Seg[j] = Operate(node.Seg[2 * j], node.Seg[2 * j + 1]);
+            if (node.ParentIndex == -1)
+                continue;
+            Node &parent = Nodes[node.Adjacent[node.ParentIndex]];
+            parent.Seg[parent.Capacity +
+                       node.IndexForAdjacent[node.ParentIndex]] =
+                OperateNode(node.Seg[1], index);
+        }
+    }
+
+    T Query(int node) {
+        ReRoot(node);
+        return OperateNode(Nodes[node].Seg[1], node);
+    }
+
+    // OperateNode(x, node) の結果が変わったあとに呼びます
+    void Update(int node) { ReRoot(node); }
+
+    // u と v は別の連結成分にある必要があります
+    void Link(int u, int v) {
+        ReRoot(u);
+        ReRoot(v);
+        assert(Nodes[u].ParentIndex == -1);
+        int iu = Append(u, v, -1);
+        int iv = Append(v, u, iu);
+        Nodes[u].IndexForAdjacent[iu] = iv;
+        Set(u, iu, OperateNode(Nodes[v].Seg[1], v));
+        Nodes[v].ParentIndex = iv;
+    }
+
+    // 辺 (u, v) が存在する必要があります
+    void Cut(int u, int v) {
+        ReRoot(u);
+        Node &node = Nodes[v];
+        assert(node.ParentIndex != -1 &&
+               node.Adjacent[node.ParentIndex] == u);
+        int iv = node.ParentIndex;
+        int iu = node.IndexForAdjacent[iv];
+        node.ParentIndex = -1;
+        Remove(v, iv);
+        Remove(u, iu);
+    }
+
+private:
+    void Set(int index, int i, T value) {
+        Node &node = Nodes[index];
+        i += node.Capacity;
+        node.Seg[i] = std::move(value);
+        for (i /= 2; i >= 1; i /= 2)
+            node.Seg[i] = Operate(node.Seg[2 * i], node.Seg[2 * i + 1]);
+    }
+
+    // 親を 1 辺ずつ根の側から index まで動かします
+    void ReRoot(int index) {
+        Path.clear();
+        for (int v = index; Nodes[v].ParentIndex != -1;
+             v = Nodes[v].Adjacent[Nodes[v].ParentIndex])
+            Path.push_back(v);
+        for (int k = (int)Path.size() - 1; k >= 0; k--) {
+            int child = Path[k];
+            Node &c = Nodes[child];
+            int parent = c.Adjacent[c.ParentIndex];
+            int ip = c.IndexForAdjacent[c.ParentIndex];
+            Set(parent, ip, Identity);
+            Set(child, c.ParentIndex,
+                OperateNode(Nodes[parent].Seg[1], parent));
+            Nodes[parent].ParentIndex = ip;
+            c.ParentIndex = -1;
+        }
+    }
+
+    // 新しい位置を返します
+    int Append(int index, int adjacent, int indexForAdjacent) {
+        Node &node = Nodes[index];
+        int size = node.Adjacent.size();
+        if (size == node.Capacity) {
+            Rebuild(index, size + 1);
+            size = node.Adjacent.size();
+        }
+        node.Adjacent.push_back(adjacent);
+        node.IndexForAdjacent.push_back(indexForAdjacent);
+        return size;
+    }
+
+    void Remove(int index, int i) {
+        Node &node = Nodes[index];
+        node.Adjacent[i] = -1;
+        Set(index, i, Identity);
+        node.Removed++;
+        if (node.Removed * 2 > node.Adjacent.size())
+            Rebuild(index, 0);
+    }
+
+    // 削除した辺を詰めて、容量を capacity 以上の最小の 2 冪にします
+    void Rebuild(int index, int capacity) {
+        Node &node = Nodes[index];
+        int size = 0;
+        std::vector<T> values;
+        for (int i = 0; i < node.Adjacent.size(); i++) {
+            if (node.Adjacent[i] == -1)
+                continue;
+            if (i == node.ParentIndex)
+                node.ParentIndex = size;
+            node.Adjacent[size] = node.Adjacent[i];
+            node.IndexForAdjacent[size] = node.IndexForAdjacent[i];
+            Nodes[node.Adjacent[size]]
+                .IndexForAdjacent[node.IndexForAdjacent[size]] = size;
+            values.push_back(std::move(node.Seg[node.Capacity + i]));
+            size++;
+        }
+        node.Adjacent.resize(size);
+        node.IndexForAdjacent.resize(size);
+        node.Removed = 0;
+        node.Capacity = 1;
+        while (node.Capacity < std::max(size, capacity))
+            node.Capacity *= 2;
+        node.Seg.assign(node.Capacity * 2, Identity);
+        for (int i = 0; i < size; i++)
+            node.Seg[node.Capacity + i] = std::move(values[i]);
+        for (int i = node.Capacity - 1; i >= 1; i--)
+            node.Seg[i] = Operate(node.Seg[2 * i], node.Seg[2 * i + 1]);
+    }
+};
+
+// Operate(T, T) -> T, Lift(T, T, int) -> F, Compose(F, F) -> F,
+// Apply(F, T) -> T
+// Lift(l, r, v) は x -> OperateNode(Operate(Operate(l, x), r), v) を表す F を、
+// Compose(f, g) は f と g の合成 x -> f(g(x)) を、Apply(f, x) は f(x) を返します
+// Identity は Operate の単位元である必要があります
+template <class T, class F, class Op, class LiftOp, class ComposeOp,
+          class ApplyOp>
+class LinkCutReRooting {
+public:
+    int NodeCount;
+
+private:
+    // 頂点と辺をどちらも link-cut tree の頂点にします
+    // 優先辺でつながった経路ごとに、根に近い順に並べた splay 木を作ります
+    // 経路の先頭は常に辺で、それ以外の経路は先頭の辺の位置に値を置いて
+    // 経路の親の頂点のセグメント木に持ちます
+    struct Node {
+        int Child[2];
+        // splay 木の親、splay 木の根なら経路の親、どちらもなければ -1
+        int Parent;
+        bool Reversed;
+        bool IsEdge;
+        // 部分木に頂点がないかどうか
+        bool Empty;
+        // 部分木の経路の先頭と末尾
+        int Top;
+        int Bottom;
+        // 頂点で、経路の上と下の辺の位置、なければ -1
+        int Above;
+        int Below;
+        // 頂点で、x を下の辺 / 上の辺の位置に置いたときの関数
+        // 辺では使いません
+        F SelfDown;
+        F SelfUp;
+        // 部分木の経路の関数を、根に近い側を外側にして合成したものと
+        // 遠い側を外側にして合成したもの
+        F Down;
+        F Up;
+        // 頂点で、辺を追加した順で、削除した辺は -1
+        std::vector<int> Edges;
+        // 葉は Capacity + 位置で、経路の辺と削除した辺の位置は Identity
+        std::vector<T> Light;
+        int Capacity;
+        int Removed;
+        // 辺で、両端の頂点と各頂点の Edges での位置
+        int Ends[2];
+        int SlotAt[2];
+
+        Node(bool isEdge, const F &f, const T &identity)
+            : Child{-1, -1}, Parent(-1), Reversed(false), IsEdge(isEdge),
+              Empty(isEdge), Top(-1), Bottom(-1), Above(-1), Below(-1),
+              SelfDown(f), SelfUp(f), Down(f), Up(f), Edges(),
+              Light(isEdge ? 0 : 2, identity), Capacity(1), Removed(0),
+              Ends{-1, -1}, SlotAt{-1, -1} {}
+    };
+
+    std::vector<Node> Nodes;
+    std::vector<int> FreeEdges;
+    std::vector<int> Path;
+
+    T Identity;
+    Op Operate;
+    LiftOp Lift;
+    ComposeOp Compose;
+    ApplyOp Apply;
+
+public:
+    template <class EdgeRange>
+    LinkCutReRooting(int nodeCount, const EdgeRange &edges, T identity,
+                     Op operate, LiftOp lift, ComposeOp compose,
+                     ApplyOp apply)
+        : NodeCount(nodeCount), Identity(std::move(identity)),
+          Operate(std::move(operate)), Lift(std::move(lift)),
+          Compose(std::move(compose)), Apply(std::move(apply)) {
+        Nodes.reserve(nodeCount * 2);
+        for (int i = 0; i < nodeCount; i++) {
+            Nodes.emplace_back(false, Lift(Identity, Identity, i), Identity);
+            Nodes[i].Top = Nodes[i].Bottom = i;
+        }
+        for (const auto &edge : edges)
+            Link(edge[0], edge[1]);
+    }
+
+    T Query(int node) {
+        Access(node);
+        return Apply(Nodes[node].Up, Identity);
+    }
+
+    // Lift(l, r, node) の結果が変わったあとに呼びます
+    void Update(int node) {
+        Access(node);
+        Refresh(node);
+    }
+
+    // u と v は別の連結成分にある必要があります
+    void Link(int u, int v) {
+        int e = NewEdge(u, v);
+        Evert(u);
+        Access(v);
+        assert(Nodes[u].Parent == -1);
+        Nodes[e].Child[1] = u;
+        Nodes[u].Parent = e;
+        Nodes[u].Above = Nodes[e].SlotAt[0];
+        Refresh(u);
+        Pull(e);
+        Nodes[e].Parent = v;
+        AddLight(v, e);
+        Refresh(v);
+    }
+
+    // 辺 (u, v) が存在する必要があります
+    void Cut(int u, int v) {
+        Evert(u);
+        Access(v);
+        assert(Nodes[v].Above != -1);
+        int e = Nodes[v].Edges[Nodes[v].Above];
+        assert(Nodes[e].Ends[0] == u || Nodes[e].Ends[1] == u);
+        Nodes[Nodes[v].Child[0]].Parent = -1;
+        Nodes[v].Child[0] = -1;
+        Nodes[v].Above = -1;
+        Splay(e);
+        assert(Nodes[e].Child[0] == u && Nodes[e].Child[1] == -1);
+        Nodes[u].Parent = -1;
+        Nodes[u].Below = -1;
+        Nodes[e].Child[0] = -1;
+        for (int k = 0; k < 2; k++) {
+            int x = Nodes[e].Ends[k];
+            Node &node = Nodes[x];
+            node.Edges[Nodes[e].SlotAt[k]] = -1;
+            node.Removed++;
+            if (node.Removed * 2 > node.Edges.size())
+                Rebuild(x, 0);
+            Refresh(x);
+        }
+        FreeEdges.push_back(e);
+    }
+
+private:
+    bool IsRoot(int index) const {
+        int p = Nodes[index].Parent;
+        return p == -1 ||
+               (Nodes[p].Child[0] != index && Nodes[p].Child[1] != index);
+    }
+
+    // index が頂点 x に接する辺のとき、x の Edges での位置
+    int SlotOf(int index, int x) const {
+        const Node &e = Nodes[index];
+        return e.SlotAt[e.Ends[0] == x ? 0 : 1];
+    }
+
+    void Reverse(int index) {
+        if (index == -1)
+            return;
+        Node &node = Nodes[index];
+        std::swap(node.Child[0], node.Child[1]);
+        std::swap(node.Top, node.Bottom);
+        std::swap(node.Above, node.Below);
+        std::swap(node.SelfDown, node.SelfUp);
+        std::swap(node.Down, node.Up);
+        node.Reversed = !node.Reversed;
+    }
+
+    void Push(int index) {
+        Node &node = Nodes[index];
+        if (!node.Reversed)
+            return;
+        Reverse(node.Child[0]);
+        Reverse(node.Child[1]);
+        node.Reversed = false;
+    }
+
+    void Pull(int index) {
+        Node &node = Nodes[index];
+        node.Top = node.Bottom = index;
+        node.Empty = node.IsEdge;
+        if (!node.IsEdge) {
+            node.Down = node.SelfDown;
+            node.Up = node.SelfUp;
+        }
+        if (node.Child[0] != -1) {
+            const Node &l = Nodes[node.Child[0]];
+            node.Top = l.Top;
+            if (!l.Empty) {
+                node.Down = node.Empty ? l.Down : Compose(l.Down, node.Down);
+                node.Up = node.Empty ? l.Up : Compose(node.Up, l.Up);
+                node.Empty = false;
+            }
+        }
+        if (node.Child[1] != -1) {
+            const Node &r = Nodes[node.Child[1]];
+            node.Bottom = r.Bottom;
+            if (!r.Empty) {
+                node.Down = node.Empty ? r.Down : Compose(node.Down, r.Down);
+                node.Up = node.Empty ? r.Up : Compose(r.Up, node.Up);
+                node.Empty = false;
+            }
+        }
+    }
+
+    // Light の [l, r) を順に畳み込みます
+    T Fold(const Node &node, int l, int r) const {
+        T left = Identity, right = Identity;
+        for (l += node.Capacity, r += node.Capacity; l < r; l /= 2, r /= 2) {
+            if (l & 1)
+                left = Operate(left, node.Light[l++]);
+            if (r & 1)
+                right = Operate(node.Light[--r], right);
+        }
+        return Operate(left, right);
+    }
+
+    F Side(int index, int slot) const {
+        const Node &node = Nodes[index];
+        if (slot == -1)
+            return Lift(node.Light[1], Identity, index);
+        return Lift(Fold(node, 0, slot),
+                    Fold(node, slot + 1, node.Capacity), index);
+    }
+
+    void Refresh(int index) {
+        Push(index);
+        Node &node = Nodes[index];
+        node.SelfDown = Side(index, node.Below);
+        node.SelfUp = Side(index, node.Above);
+        Pull(index);
+    }
+
+    void Rotate(int index) {
+        Node &x = Nodes[index];
+        int parent = x.Parent;
+        Node &y = Nodes[parent];
+        int grand = y.Parent;
+        if (!IsRoot(parent)) {
+            Node &z = Nodes[grand];
+            z.Child[z.Child[1] == parent] = index;
+        }
+        x.Parent = grand;
+        int dir = y.Child[1] == index;
+        y.Child[dir] = x.Child[!dir];
+        if (y.Child[dir] != -1)
+            Nodes[y.Child[dir]].Parent = parent;
+        x.Child[!dir] = parent;
+        y.Parent = index;
+        Pull(parent);
+        Pull(index);
+    }
+
+    void Splay(int index) {
+        Path.clear();
+        for (int v = index;; v = Nodes[v].Parent) {
+            Path.push_back(v);
+            if (IsRoot(v))
+                break;
+        }
+        for (int k = (int)Path.size() - 1; k >= 0; k--)
+            Push(Path[k]);
+        while (!IsRoot(index)) {
+            int parent = Nodes[index].Parent;
+            if (!IsRoot(parent)) {
+                int grand = Nodes[parent].Parent;
+                bool zigzig = (Nodes[grand].Child[1] == parent) ==
+                              (Nodes[parent].Child[1] == index);
+                Rotate(zigzig ? parent : index);
+            }
+            Rotate(index);
+        }
+    }
+
+    // 根から頂点 index までを 1 つの経路にして、index を splay 木の根にします
+    // 経路の親は常に頂点です
+    void Access(int index) {
+        for (int v = index, last = -1; v != -1;
+             last = v, v = Nodes[v].Parent) {
+            Splay(v);
+            Node &node = Nodes[v];
+            if (node.Child[1] != -1)
+                AddLight(v, node.Child[1]);
+            if (last != -1)
+                SetLight(v, SlotOf(Nodes[last].Top, v), Identity);
+            node.Child[1] = last;
+            node.Below = last == -1 ? -1 : SlotOf(Nodes[last].Top, v);
+            Refresh(v);
+        }
+        Splay(index);
+    }
+
+    void Evert(int index) {
+        Access(index);
+        Reverse(index);
+    }
+
+    void SetLight(int index, int i, T value) {
+        Node &node = Nodes[index];
+        i += node.Capacity;
+        node.Light[i] = std::move(value);
+        for (i /= 2; i >= 1; i /= 2)
+            node.Light[i] =
+                Operate(node.Light[2 * i], node.Light[2 * i + 1]);
+    }
+
+    // child は splay 木の根で、その経路の値を先頭の辺の位置に置きます
+    void AddLight(int index, int child) {
+        SetLight(index, SlotOf(Nodes[child].Top, index),
+                 Apply(Nodes[child].Down, Identity));
+    }
+
+    int NewEdge(int u, int v) {
+        int e;
+        if (FreeEdges.empty()) {
+            e = Nodes.size();
+            F placeholder = Nodes[u].SelfDown;
+            Nodes.emplace_back(true, placeholder, Identity);
+        } else {
+            e = FreeEdges.back();
+            FreeEdges.pop_back();
+            Nodes[e].Child[0] = Nodes[e].Child[1] = -1;
+            Nodes[e].Parent = -1;
+            Nodes[e].Reversed = false;
+        }
+        Nodes[e].Ends[0] = u;
+        Nodes[e].Ends[1] = v;
+        Nodes[e].SlotAt[0] = Append(u, e);
+        Nodes[e].SlotAt[1] = Append(v, e);
+        Pull(e);
+        return e;
+    }
+
+    // 新しい位置を返します
+    int Append(int index, int edge) {
+        Node &node = Nodes[index];
+        int size = node.Edges.size();
+        if (size == node.Capacity) {
+            Rebuild(index, size + 1);
+            size = node.Edges.size();
+        }
+        node.Edges.push_back(edge);
+        return size;
+    }
+
+    // 削除した辺を詰めて、容量を capacity 以上の最小の 2 冪にします
+    // 位置は変わっても Light の畳み込みは変わりません
+    void Rebuild(int index, int capacity) {
+        Node &node = Nodes[index];
+        int size = 0;
+        std::vector<T> values;
+        for (int i = 0; i < node.Edges.size(); i++) {
+            int e = node.Edges[i];
+            if (e == -1)
+                continue;
+            if (node.Above == i)
+                node.Above = size;
+            if (node.Below == i)
+                node.Below = size;
+            Node &edge = Nodes[e];
+            edge.SlotAt[edge.Ends[0] == index ? 0 : 1] = size;
+            node.Edges[size] = e;
+            values.push_back(std::move(node.Light[node.Capacity + i]));
+            size++;
+        }
+        node.Edges.resize(size);
+        node.Removed = 0;
+        node.Capacity = 1;
+        while (node.Capacity < std::max(size, capacity))
+            node.Capacity *= 2;
+        node.Light.assign(node.Capacity * 2, Identity);
+        for (int i = 0; i < size; i++)
+            node.Light[node.Capacity + i] = std::move(values[i]);
+        for (int i = node.Capacity - 1; i >= 1; i--)
+            node.Light[i] = Operate(node.Light[2 * i], node.Light[2 * i + 1]);
+    }
+};
+
+template <class EdgeRange, class T, class Op, class LiftOp, class ComposeOp,
+          class ApplyOp>
+LinkCutReRooting(int, const EdgeRange &, T, Op, LiftOp, ComposeOp, ApplyOp)
+    -> LinkCutReRooting<
+        T, std::invoke_result_t<LiftOp &, const T &, const T &, int>, Op,
+        LiftOp, ComposeOp, ApplyOp>;
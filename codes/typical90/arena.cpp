@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Per-thread bump allocator with a free list per power-of-two size class.
+// Freeing the most recent allocation gives the memory back to the bump
+// pointer, anything else goes to the free list of its class and is reused
+// before reset(), which resets the arenas of all threads at once. A block
+// freed by another thread joins that thread's lists, which is why resets
+// cannot be per thread. Chunks are kept across resets.
+class arena {
+  using usize = std::size_t;
+
+  static constexpr usize chunk_size = usize(1) << 22;
+  static constexpr usize align = alignof(std::max_align_t);
+  static constexpr int classes = 64;
+
+  struct free_block {
+    free_block *next;
+  };
+
+  struct state {
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::vector<usize> sizes;
+    usize cur;
+    usize top;
+    std::array<free_block *, classes> free;
+
+    state() : chunks(), sizes(), cur(0), top(0), free() {
+      registry &r = all();
+      std::lock_guard<std::mutex> lock(r.m);
+      r.states.push_back(this);
+    }
+
+    ~state() {
+      registry &r = all();
+      std::lock_guard<std::mutex> lock(r.m);
+      r.states.erase(std::find(r.states.begin(), r.states.end(), this));
+    }
+  };
+
+  struct registry {
+    std::mutex m;
+    std::vector<state *> states;
+  };
+
+  static registry &all() {
+    static registry r;
+    return r;
+  }
+
+  static state &get() {
+    static thread_local state s;
+    return s;
+  }
+
+  // The smallest k with bytes <= align << k.
+  static int size_class(const usize bytes) {
+    return bytes <= align ? 0
+                          : std::numeric_limits<usize>::digits -
+                                __builtin_clzll((bytes - 1) / align);
+  }
+
+public:
+  static void *allocate(usize bytes) {
+    const int k = size_class(bytes);
+    bytes = align << k;
+    state &s = get();
+    if (free_block *const b = s.free[k]) {
+      s.free[k] = b->next;
+      return b;
+    }
+    if (s.chunks.empty() || s.top + bytes > s.sizes[s.cur]) {
+      if (!s.chunks.empty()) {
+        s.cur += 1;
+      }
+      if (s.cur == s.chunks.size() || s.sizes[s.cur] < bytes) {
+        const usize size = std::max(chunk_size, bytes);
+        s.chunks.emplace(s.chunks.begin() + s.cur, new std::byte[size]);
+        s.sizes.insert(s.sizes.begin() + s.cur, size);
+      }
+      s.top = 0;
+    }
+    void *const ret = s.chunks[s.cur].get() + s.top;
+    s.top += bytes;
+    return ret;
+  }
+
+  static void deallocate(void *const p, usize bytes) {
+    const int k = size_class(bytes);
+    bytes = align << k;
+    state &s = get();
+    if (!s.chunks.empty() && s.top >= bytes &&
+        static_cast<std::byte *>(p) == s.chunks[s.cur].get() + s.top - bytes) {
+      s.top -= bytes;
+    } else {
+      s.free[k] = new (p) free_block{s.free[k]};
+    }
+  }
+
+  // No thread may be using the arena, and what they did before must happen
+  // before this call, as for the tasks of a pool that have all been joined.
+  static void reset() {
+    registry &r = all();
+    std::lock_guard<std::mutex> lock(r.m);
+    for (state *const s : r.states) {
+      s->cur = 0;
+      s->top = 0;
+      s->free.fill(nullptr);
+    }
+  }
+
+  // Everything allocated from the arena, by any thread, must be gone when a
+  // scope ends.
+  class scope {
+  public:
+    scope() {}
+    ~scope() { reset(); }
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+  };
+};
+
+template <class T> class arena_allocator {
+public:
+  using value_type = T;
+
+  arena_allocator() noexcept {}
+  template <class U> arena_allocator(const arena_allocator<U> &) noexcept {}
+
+  T *allocate(const std::size_t n) {
+    return static_cast<T *>(arena::allocate(n * sizeof(T)));
+  }
+  void deallocate(T *const p, const std::size_t n) noexcept {
+    arena::deallocate(p, n * sizeof(T));
+  }
+
+  template <class U> bool operator==(const arena_allocator<U> &) const {
+    return true;
+  }
+  template <class U> bool operator!=(const arena_allocator<U> &) const {
+    return false;
+  }
+};
@@ -0,0 +1,357 @@
+#include "global_biased_merge.cpp"
+#include "isets.cpp"
+
+#include "../modint_combination.cpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Usage: benchmark [data=DIR] [shapes=path,star,...] [sizes=N,N,...]
+//                  [threads=T] [brute=COUNT] [seed=S]
+// Prints one JSON object per line: a "check" record per verified case and a
+// "phase" record per phase of every generated tree. Exits with 1 if any check
+// fails. Peak RSS is reset at the start of each phase where the kernel allows
+// it (rss_reset is false otherwise and the value is the process peak).
+
+namespace {
+
+std::atomic<std::uint64_t> alloc_count(0);
+std::atomic<std::uint64_t> alloc_bytes(0);
+
+// The replacements go through these so that GCC does not pair the inlined
+// std::free with operator new and warn about a mismatched deallocation.
+[[gnu::noinline]] void *counted_alloc(const std::size_t n) {
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+  if (void *const p = std::malloc(n == 0 ? 1 : n)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+[[gnu::noinline]] void counted_free(void *const p) noexcept { std::free(p); }
+
+} // namespace
+
+void *operator new(const std::size_t n) { return counted_alloc(n); }
+void operator delete(void *const p) noexcept { counted_free(p); }
+void operator delete(void *const p, std::size_t) noexcept { counted_free(p); }
+void *operator new[](const std::size_t n) { return counted_alloc(n); }
+void operator delete[](void *const p) noexcept { counted_free(p); }
+void operator delete[](void *const p, std::size_t) noexcept {
+  counted_free(p);
+}
+
+using edges = std::vector<std::array<int, 2>>;
+
+bool reset_peak_rss() {
+  std::FILE *const f = std::fopen("/proc/self/clear_refs", "w");
+  if (f == nullptr) {
+    return false;
+  }
+  const bool ok = std::fputs("5", f) >= 0;
+  return std::fclose(f) == 0 && ok;
+}
+
+long peak_rss_kb() {
+  std::ifstream in("/proc/self/status");
+  std::string key;
+  while (in >> key) {
+    if (key == "VmHWM:") {
+      long kb;
+      in >> kb;
+      return kb;
+    }
+    in.ignore(1 << 10, '\n');
+  }
+  return -1;
+}
+
+class phase_log {
+  using clock = std::chrono::steady_clock;
+
+  std::string tree;
+  int n;
+  const char *name;
+  clock::time_point start;
+  std::uint64_t count;
+  std::uint64_t bytes;
+  bool reset;
+
+public:
+  phase_log(std::string tree_, const int n_)
+      : tree(std::move(tree_)), n(n_), name(nullptr), start(), count(0),
+        bytes(0), reset(false) {}
+
+  void operator()(const char *const next) {
+    const clock::time_point now = clock::now();
+    const double ms =
+        std::chrono::duration<double, std::milli>(now - start).count();
+    if (name != nullptr) {
+      std::printf("{\"type\":\"phase\",\"tree\":\"%s\",\"n\":%d,"
+                  "\"phase\":\"%s\",\"ms\":%.3f,\"peak_rss_kb\":%ld,"
+                  "\"rss_reset\":%s,\"allocs\":%llu,\"alloc_bytes\":%llu}\n",
+                  tree.c_str(), n, name, ms, peak_rss_kb(),
+                  reset ? "true" : "false",
+                  (unsigned long long)(alloc_count.load() - count),
+                  (unsigned long long)(alloc_bytes.load() - bytes));
+      std::fflush(stdout);
+    }
+    name = next;
+    if (name != nullptr) {
+      reset = reset_peak_rss();
+      count = alloc_count.load();
+      bytes = alloc_bytes.load();
+      start = clock::now();
+    }
+  }
+};
+
+// Coefficients of the independent set polynomial, as in solution.cpp.
+std::vector<std::uint32_t> solve(const int n, edges ends, task_pool *const pool,
+                                 phase_log *const log) {
+  arena::scope arena_scope;
+  std::vector<std::uint32_t> ret(n + 1);
+  if (n == 1) {
+    ret = {1, 1};
+  } else {
+    std::function<void(const char *)> phase;
+    if (log != nullptr) {
+      phase = [log](const char *const name) { (*log)(name); };
+    }
+    isets res = global_biased_merge(
+        n, std::move(ends), [](int) { return isets(0); }, pool, 1 << 12,
+        phase);
+    if (log != nullptr) {
+      (*log)("result");
+    }
+    const std::vector<modint> ans = res.result().to_vector(n + 1);
+    for (int i = 0; i <= n; i += 1) {
+      ret[i] = ans[i].val();
+    }
+  }
+  if (log != nullptr) {
+    (*log)(nullptr);
+  }
+  return ret;
+}
+
+std::vector<std::uint32_t> brute(const int n, const edges &ends) {
+  std::vector<std::uint32_t> ret(n + 1, 0);
+  for (std::uint32_t s = 0; s != std::uint32_t(1) << n; s += 1) {
+    bool ok = true;
+    for (const auto &[u, v] : ends) {
+      ok &= (s >> u & s >> v & 1) == 0;
+    }
+    ret[__builtin_popcount(s)] += ok;
+  }
+  return ret;
+}
+
+// Closed forms for the shapes that have one, empty otherwise.
+std::vector<std::uint32_t> expected(const std::string &shape, const int n) {
+  static factorial_table<modint> table;
+  std::vector<std::uint32_t> ret;
+  if (shape == "path") {
+    for (int k = 0; k <= n; k += 1) {
+      ret.push_back(table.binom(n - k + 1, k).val());
+    }
+  } else if (shape == "star") {
+    for (int k = 0; k <= n; k += 1) {
+      ret.push_back((table.binom(n - 1, k) + modint(k == 1)).val());
+    }
+  }
+  return ret;
+}
+
+edges generate(const std::string &shape, const int n, std::mt19937_64 &rng) {
+  edges ret;
+  ret.reserve(n - 1);
+  if (shape == "path") {
+    for (int v = 1; v != n; v += 1) {
+      ret.push_back({v - 1, v});
+    }
+  } else if (shape == "star") {
+    for (int v = 1; v != n; v += 1) {
+      ret.push_back({0, v});
+    }
+  } else if (shape == "caterpillar") {
+    const int spine = (n + 1) / 2;
+    for (int v = 1; v != n; v += 1) {
+      ret.push_back({v < spine ? v - 1 : (v - spine) % spine, v});
+    }
+  } else if (shape == "binary") {
+    for (int v = 1; v != n; v += 1) {
+      ret.push_back({(v - 1) / 2, v});
+    }
+  } else if (shape == "prufer") {
+    if (n == 2) {
+      ret.push_back({0, 1});
+    } else if (n > 2) {
+      std::vector<int> code(n - 2), degree(n, 1);
+      for (int &x : code) {
+        x = rng() % n;
+        degree[x] += 1;
+      }
+      // Linear-time decoding: the smallest leaf is tracked by a pointer that
+      // only moves forward, except for leaves created behind it.
+      int ptr = 0;
+      while (degree[ptr] != 1) {
+        ptr += 1;
+      }
+      int leaf = ptr;
+      for (const int v : code) {
+        ret.push_back({leaf, v});
+        degree[leaf] = 0;
+        if (--degree[v] == 1 && v < ptr) {
+          leaf = v;
+        } else {
+          ptr += 1;
+          while (degree[ptr] != 1) {
+            ptr += 1;
+          }
+          leaf = ptr;
+        }
+      }
+      ret.push_back({leaf, n - 1});
+    }
+  } else {
+    std::fprintf(stderr, "unknown shape: %s\n", shape.c_str());
+    std::exit(2);
+  }
+
+  // Random labels and edge order, so no shape is laid out in BFS order.
+  std::vector<int> label(n);
+  std::iota(label.begin(), label.end(), 0);
+  std::shuffle(label.begin(), label.end(), rng);
+  for (auto &[u, v] : ret) {
+    u = label[u];
+    v = label[v];
+    if (rng() % 2 != 0) {
+      std::swap(u, v);
+    }
+  }
+  std::shuffle(ret.begin(), ret.end(), rng);
+  return ret;
+}
+
+std::vector<std::string> split(const std::string &s) {
+  std::vector<std::string> ret;
+  std::size_t p = 0;
+  while (p <= s.size()) {
+    const std::size_t q = std::min(s.find(',', p), s.size());
+    if (q != p) {
+      ret.push_back(s.substr(p, q - p));
+    }
+    p = q + 1;
+  }
+  return ret;
+}
+
+int failures = 0;
+
+void report_check(const std::string &name, const int n, const bool ok) {
+  failures += !ok;
+  std::printf("{\"type\":\"check\",\"case\":\"%s\",\"n\":%d,\"ok\":%s}\n",
+              name.c_str(), n, ok ? "true" : "false");
+  std::fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  std::string data = ".";
+  std::vector<std::string> shapes = {"path", "star", "caterpillar", "prufer",
+                                     "binary"};
+  std::vector<int> sizes = {1000, 10000, 100000, 1000000};
+  unsigned threads = std::thread::hardware_concurrency();
+  int brute_count = 200;
+  std::uint64_t seed = 91;
+  for (int i = 1; i < argc; i += 1) {
+    const std::string arg = argv[i];
+    const std::size_t eq = arg.find('=');
+    const std::string key = arg.substr(0, eq);
+    const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (key == "data") {
+      data = value;
+    } else if (key == "shapes") {
+      shapes = split(value);
+    } else if (key == "sizes") {
+      sizes.clear();
+      for (const std::string &s : split(value)) {
+        sizes.push_back(std::stoi(s));
+      }
+    } else if (key == "threads") {
+      threads = std::stoi(value);
+    } else if (key == "brute") {
+      brute_count = std::stoi(value);
+    } else if (key == "seed") {
+      seed = std::stoull(value);
+    } else {
+      std::fprintf(stderr, "unknown argument: %s\n", arg.c_str());
+      return 2;
+    }
+  }
+
+  task_pool pool(threads > 1 ? threads - 1 : 0);
+  task_pool *const pool_ptr = threads > 1 ? &pool : nullptr;
+  std::mt19937_64 rng(seed);
+
+  for (int t = 1; t <= 99; t += 1) {
+    char id[8];
+    std::snprintf(id, sizeof(id), "%02d", t);
+    const std::string in_path = data + "/input/" + id + ".txt";
+    std::ifstream in(in_path), out(data + "/output/" + id + ".txt");
+    if (!in || !out) {
+      break;
+    }
+    int n;
+    in >> n;
+    edges ends(n - 1);
+    for (auto &[a, b] : ends) {
+      in >> a >> b;
+      a -= 1;
+      b -= 1;
+    }
+    std::vector<std::uint32_t> want(n + 1);
+    for (std::uint32_t &x : want) {
+      out >> x;
+    }
+    report_check(in_path, n, solve(n, std::move(ends), pool_ptr, nullptr) ==
+                                 want);
+  }
+
+  for (int i = 0; i != brute_count; i += 1) {
+    const std::string &shape = shapes[i % shapes.size()];
+    const int n = 1 + i / shapes.size() % 16;
+    const edges ends = generate(shape, n, rng);
+    report_check("brute/" + shape, n,
+                 solve(n, ends, pool_ptr, nullptr) == brute(n, ends));
+  }
+
+  for (const int n : sizes) {
+    for (const std::string &shape : shapes) {
+      phase_log log(shape, n);
+      log("generate");
+      edges ends = generate(shape, n, rng);
+      const std::vector<std::uint32_t> ans =
+          solve(n, std::move(ends), pool_ptr, &log);
+      const std::vector<std::uint32_t> want = expected(shape, n);
+      if (!want.empty()) {
+        report_check("formula/" + shape, n, ans == want);
+      }
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
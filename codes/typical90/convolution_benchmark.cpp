@@ -0,0 +1,142 @@
+#include "global_biased_merge.cpp"
+
+#include "../ntt.cpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if __has_include(<atcoder/convolution>)
+#include <atcoder/convolution>
+#include <atcoder/modint>
+#define HAVE_ATCODER
+#endif
+
+using usize = std::size_t;
+
+// Follows the polynomial lengths of isets in isets.cpp, counted from x^0, and
+// records the operand lengths of every term passed to poly::sum_of_products
+// as one product each. isets batches the larger sums into shared transforms
+// instead, so this replays the unbatched cost that both libraries are
+// compared on.
+std::vector<std::pair<usize, usize>> products;
+
+struct shape {
+  std::array<std::array<usize, 2>, 2> len;
+
+  shape(int) : len() {
+    len[0][0] = 1;
+    len[0][1] = 1;
+    len[1][0] = 1;
+  }
+
+  static usize mul(const usize l, const usize r) {
+    if (l == 0 || r == 0)
+      return 0;
+    products.push_back({l, r});
+    return l + r - 1;
+  }
+
+  static shape compress(shape l, shape r) {
+    shape ret(0);
+    for (int i = 0; i != 2; i += 1) {
+      for (int j = 0; j != 2; j += 1) {
+        const usize a = mul(l.len[i][1], r.len[1][j]) + 1;
+        const usize b = mul(l.len[i][0], r.len[0][j]);
+        ret.len[i][j] = std::max(a, b);
+      }
+    }
+    return ret;
+  }
+
+  static shape rake(shape child, shape base) {
+    for (int i = 0; i != 2; i += 1) {
+      child.len[i][1] = std::max(child.len[i][1] + 1, child.len[i][0]);
+      for (int j = 0; j != 2; j += 1) {
+        base.len[i][j] = mul(base.len[i][j], child.len[i][1]);
+      }
+    }
+    return base;
+  }
+
+  void flip() { std::swap(len[0][1], len[1][0]); }
+};
+
+template <class F> double time_ms(F f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template <class M, class Mul>
+double replay(const std::vector<std::pair<usize, usize>> &prods, Mul mul,
+              std::uint32_t &check) {
+  std::mt19937 rnd(91);
+  std::vector<std::pair<std::vector<M>, std::vector<M>>> in;
+  for (const auto &[l, r] : prods) {
+    std::vector<M> a(l), b(r);
+    for (M &x : a)
+      x = rnd();
+    for (M &x : b)
+      x = rnd();
+    in.push_back({std::move(a), std::move(b)});
+  }
+  check = 0;
+  return time_ms([&]() {
+    for (auto &[a, b] : in)
+      check += mul(a, b).back().val();
+  });
+}
+
+int main(int argc, char **argv) {
+  for (int f = 1; f < argc; f += 1) {
+    std::ifstream in(argv[f]);
+    int n;
+    in >> n;
+    std::vector<std::tuple<int, int, shape>> edges;
+    for (int i = 1; i <= n - 1; i += 1) {
+      int a, b;
+      in >> a >> b;
+      edges.push_back({a - 1, b - 1, shape(0)});
+    }
+    products.clear();
+    global_biased_merge(n, std::move(edges));
+
+    usize elems = 0;
+    for (const auto &[l, r] : products)
+      elems += l + r - 1;
+    std::cout << argv[f] << ": N = " << n << ", " << products.size()
+              << " products, " << elems << " output coefficients\n";
+
+    std::uint32_t check;
+    using conv = ntt<998244353>;
+    const double own = replay<conv::mint>(
+        products,
+        [](const std::vector<conv::mint> &a,
+           const std::vector<conv::mint> &b) { return conv::multiply(a, b); },
+        check);
+    std::cout << "  ntt::multiply        " << own << " ms  (" << check
+              << ")\n";
+#ifdef HAVE_ATCODER
+    using amint = atcoder::static_modint<998244353>;
+    const double ac = replay<amint>(
+        products,
+        [](const std::vector<amint> &a, const std::vector<amint> &b) {
+          return atcoder::convolution(a, b);
+        },
+        check);
+    std::cout << "  atcoder::convolution " << ac << " ms  (" << check
+              << ")\n";
+#else
+    std::cout << "  atcoder::convolution not available\n";
+#endif
+  }
+  return 0;
+}
@@ -0,0 +1,252 @@
+#include "task_pool.cpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Edge i joins ends[i][0] and ends[i][1]. make_edge(i) returns its cluster
+// oriented from ends[i][0] to ends[i][1]; it is called once per edge, when
+// the edge is first needed, possibly on a pool thread.
+// With a pool, independent subproblems with at least grain vertices run as
+// tasks. Clusters are combined in the same order either way.
+// phase, if set, is called with "build", "precalc" and "solve" as each stage
+// starts.
+template <class MakeEdge>
+std::invoke_result_t<MakeEdge &, int>
+global_biased_merge(const int n, std::vector<std::array<int, 2>> ends,
+                    MakeEdge make_edge, task_pool *const pool = nullptr,
+                    const int grain = 1 << 12,
+                    const std::function<void(const char *)> &phase = nullptr) {
+  using Cluster = std::invoke_result_t<MakeEdge &, int>;
+
+  struct cap {
+    task_pool *pool;
+    int grain;
+    MakeEdge &make_edge;
+    // children of v are child[start[v]] .. child[start[v + 1] - 1]
+    std::vector<int> start;
+    std::vector<int> child;
+    std::vector<int> parent;
+    // number of proper descendants
+    std::vector<int> size;
+    // edge (parent[v], v) is edge edge_id[v] / 2, flipped if odd
+    std::vector<int> edge_id;
+    int root;
+
+    cap(const int n, const std::vector<std::array<int, 2>> &ends,
+        MakeEdge &make_edge_, task_pool *const pool_, const int grain_,
+        const std::function<void(const char *)> &phase)
+        : pool(pool_), grain(grain_), make_edge(make_edge_), start(n + 1, 0),
+          child(n - 1), parent(n, -1), size(n, 0), edge_id(n, -1), root(-1) {
+      assert(n >= 2);
+      assert(ends.size() == n - 1);
+      if (phase) {
+        phase("build");
+      }
+
+      std::vector<int> adj_start(n + 1, 0);
+      for (const auto &[u, v] : ends) {
+        assert(0 <= u && u < n);
+        assert(0 <= v && v < n);
+        assert(u != v);
+        adj_start[u + 1] += 1;
+        adj_start[v + 1] += 1;
+      }
+      for (int v = 0; v != n; v += 1) {
+        adj_start[v + 1] += adj_start[v];
+      }
+      // (neighbor, 2 * edge index + flip) for each endpoint
+      std::vector<std::pair<int, int>> adj(2 * (n - 1));
+      {
+        std::vector<int> pos(adj_start.begin(), adj_start.end() - 1);
+        for (int i = 0; i != n - 1; i += 1) {
+          const auto &[u, v] = ends[i];
+          adj[pos[u]++] = {v, 2 * i};
+          adj[pos[v]++] = {u, 2 * i + 1};
+        }
+      }
+
+      if (phase) {
+        phase("precalc");
+      }
+      int leaf = 0;
+      while (adj_start[leaf + 1] - adj_start[leaf] != 1) {
+        leaf += 1;
+      }
+      root = adj[adj_start[leaf]].first;
+      parent[root] = leaf;
+      edge_id[root] = adj[adj_start[leaf]].second;
+
+      std::vector<int> order;
+      order.reserve(n - 1);
+      order.push_back(root);
+      for (int i = 0; i != order.size(); i += 1) {
+        const int v = order[i];
+        start[v + 1] = adj_start[v + 1] - adj_start[v] - 1;
+        for (int j = adj_start[v]; j != adj_start[v + 1]; j += 1) {
+          const auto [c, id] = adj[j];
+          if (c != parent[v]) {
+            parent[c] = v;
+            edge_id[c] = id;
+            order.push_back(c);
+          }
+        }
+      }
+      assert(order.size() == n - 1);
+
+      for (int v = 0; v != n; v += 1) {
+        start[v + 1] += start[v];
+      }
+      std::vector<int> pos(start.begin(), start.end() - 1);
+      for (int i = 1; i != order.size(); i += 1) {
+        const int v = order[i];
+        child[pos[parent[v]]++] = v;
+      }
+      for (int i = order.size() - 1; i != 0; i -= 1) {
+        const int v = order[i];
+        size[parent[v]] += size[v] + 1;
+      }
+    }
+
+    int child_count(const int v) const { return start[v + 1] - start[v]; }
+
+    Cluster solve() { return solve_tree(root); }
+
+    Cluster get_edge(const int v) {
+      Cluster ret = make_edge(edge_id[v] / 2);
+      if (edge_id[v] % 2 != 0) {
+        ret.flip();
+      }
+      return ret;
+    }
+
+    Cluster solve_tree(const int root) {
+      int v = root;
+      while (child_count(v) != 0) {
+        int heavy = child[start[v]];
+        for (int i = start[v]; i != start[v + 1]; i += 1) {
+          if (size[child[i]] > size[heavy]) {
+            heavy = child[i];
+          }
+        }
+        v = heavy;
+      }
+      return solve_path(root, v);
+    }
+
+    task_pool::future<Cluster> fork(const int work,
+                                    std::function<Cluster()> f) {
+      if (pool != nullptr && work >= grain) {
+        return pool->spawn(std::move(f));
+      }
+      return f();
+    }
+
+    Cluster join(task_pool::future<Cluster> &f) {
+      if (pool != nullptr) {
+        pool->wait(f);
+      }
+      return f.get();
+    }
+
+    // Leaves are light children, inner nodes rake two subtrees.
+    struct merge_node {
+      int vertex;
+      int child;
+      int base;
+      int weight;
+    };
+
+    Cluster merge(const std::vector<merge_node> &tree, const int i) {
+      const merge_node &m = tree[i];
+      if (m.vertex != -1) {
+        return solve_tree(m.vertex);
+      }
+      auto child_c = fork(tree[m.child].weight,
+                          [this, &tree, m]() { return merge(tree, m.child); });
+      Cluster base_c = merge(tree, m.base);
+      return Cluster::rake(join(child_c), std::move(base_c));
+    }
+
+    Cluster solve_path(const int top, const int bottom) {
+      if (bottom == top) {
+        return get_edge(top);
+      }
+      int v = bottom;
+      while (size[top] - size[bottom] + 1 <
+             2 * (size[top] - size[parent[v]] + 1)) {
+        v = parent[v];
+      }
+      const int p = parent[v];
+      auto top_half = fork(size[top] - size[p], [this, top, p]() {
+        return solve_path(top, p);
+      });
+      std::vector<merge_node> tree;
+      std::vector<task_pool::future<Cluster>> light;
+      if (child_count(p) != 1) {
+        // The merge order depends only on sizes, so the whole Huffman tree is
+        // fixed before any cluster is computed.
+        struct heap_data {
+          int size;
+          int id;
+          bool operator<(const heap_data &r) const { return size > r.size; }
+        };
+        std::vector<heap_data> heap;
+        heap.reserve(child_count(p) - 1);
+        for (int i = start[p]; i != start[p + 1]; i += 1) {
+          const int c = child[i];
+          if (c != v) {
+            heap.push_back({size[c] + 1, int(tree.size())});
+            tree.push_back({c, -1, -1, size[c] + 1});
+          }
+        }
+        std::make_heap(heap.begin(), heap.end());
+        while (heap.size() != 1) {
+          std::pop_heap(heap.begin(), heap.end());
+          const heap_data a = heap.back();
+          heap.pop_back();
+          std::pop_heap(heap.begin(), heap.end());
+          heap_data &b = heap.back();
+          tree.push_back({-1, b.id, a.id, b.size + a.size});
+          b = {b.size + a.size, int(tree.size()) - 1};
+          std::push_heap(heap.begin(), heap.end());
+        }
+        light.push_back(fork(tree.back().weight, [this, &tree]() {
+          return merge(tree, tree.size() - 1);
+        }));
+      }
+      Cluster bottom_half = solve_path(v, bottom);
+      if (!light.empty()) {
+        bottom_half = Cluster::rake(join(light[0]), std::move(bottom_half));
+      }
+      return Cluster::compress(join(top_half), std::move(bottom_half));
+    }
+  };
+
+  cap cp(n, ends, make_edge, pool, grain, phase);
+  ends = std::vector<std::array<int, 2>>();
+  if (phase) {
+    phase("solve");
+  }
+  return cp.solve();
+}
+
+template <class Cluster>
+Cluster global_biased_merge(const int n,
+                            std::vector<std::tuple<int, int, Cluster>> edges,
+                            task_pool *const pool = nullptr,
+                            const int grain = 1 << 12) {
+  std::vector<std::array<int, 2>> ends(edges.size());
+  for (int i = 0; i != edges.size(); i += 1) {
+    ends[i] = {std::get<0>(edges[i]), std::get<1>(edges[i])};
+  }
+  return global_biased_merge(
+      n, std::move(ends),
+      [&edges](const int i) { return std::move(std::get<2>(edges[i])); }, pool,
+      grain);
+}
@@ -0,0 +1,224 @@
+#include <array>
+
+#include "../ntt.cpp"
+#include "arena.cpp"
+
+using convolution = ntt<998244353>;
+using modint = convolution::mint;
+using coeffs = std::vector<modint, arena_allocator<modint>>;
+
+// x^low * (c[0] + c[1] x + c[2] x^2 + ...)
+struct poly {
+  int low;
+  coeffs c;
+
+  poly() : low(0), c() {}
+  poly(modint c0) : low(0), c(1, c0) {}
+  poly(int low_, coeffs c_) : low(low_), c(std::move(c_)) {}
+
+  friend poly operator*(poly l, poly r) {
+    if (l.c.empty() || r.c.empty()) {
+      return poly();
+    }
+    return {l.low + r.low, convolution::multiply(std::move(l.c), r.c)};
+  }
+
+  poly &operator+=(poly r) {
+    if (r.c.empty()) {
+      return *this;
+    }
+    if (c.empty() || r.low < low) {
+      std::swap(*this, r);
+      if (r.c.empty()) {
+        return *this;
+      }
+    }
+    const int offset = r.low - low;
+    if (c.size() < offset + r.c.size()) {
+      c.resize(offset + r.c.size(), modint(0));
+    }
+    for (int i = 0; i != r.c.size(); i += 1) {
+      c[offset + i] += r.c[i];
+    }
+    return *this;
+  }
+
+  void shift() { low += 1; }
+
+  // Coefficients of x^0, ..., x^(n-1).
+  std::vector<modint> to_vector(const int n) const {
+    std::vector<modint> ret(n, modint(0));
+    for (int i = 0; i != c.size() && low + i < n; i += 1) {
+      ret[low + i] = c[i];
+    }
+    return ret;
+  }
+
+  // x^shift * l * r
+  struct term {
+    const poly *l;
+    const poly *r;
+    bool shift;
+  };
+
+  // ret[k] is the sum of the terms of sums[k]. Each distinct operand is
+  // transformed once and every output is inverted once.
+  static std::vector<poly> sum_of_products(
+      const std::vector<std::vector<term>> &sums) {
+    // Reused across calls: operand list, (output, l, r, low) per term and
+    // (low, len) per output.
+    static thread_local std::vector<const poly *> operands;
+    static thread_local std::vector<std::array<int, 4>> items;
+    static thread_local std::vector<std::array<int, 2>> range;
+    operands.clear();
+    items.clear();
+    range.assign(sums.size(), {0, 0});
+    const auto index = [&](const poly *p) -> int {
+      for (int i = 0; i != operands.size(); i += 1) {
+        if (operands[i] == p) {
+          return i;
+        }
+      }
+      operands.push_back(p);
+      return operands.size() - 1;
+    };
+    int max_len = 0;
+    long long naive_cost = 0;
+    for (int k = 0; k != sums.size(); k += 1) {
+      auto &[low, len] = range[k];
+      int high = 0;
+      for (const term &t : sums[k]) {
+        if (t.l->c.empty() || t.r->c.empty()) {
+          continue;
+        }
+        const int tl = t.l->low + t.r->low + (t.shift ? 1 : 0);
+        const int th = tl + t.l->c.size() + t.r->c.size() - 1;
+        if (len == 0) {
+          low = tl;
+          high = th;
+        } else {
+          low = std::min(low, tl);
+          high = std::max(high, th);
+        }
+        len = high - low;
+        items.push_back({k, index(t.l), index(t.r), tl});
+        naive_cost += (long long)t.l->c.size() * t.r->c.size();
+      }
+      max_len = std::max(max_len, len);
+    }
+
+    std::vector<poly> ret(sums.size());
+    const int n = convolution::transform_size(max_len);
+    int lg = 0;
+    while ((1 << lg) < n) {
+      lg += 1;
+    }
+    if (naive_cost <= (long long)(operands.size() + sums.size()) * n * lg) {
+      for (int k = 0; k != sums.size(); k += 1) {
+        for (const term &t : sums[k]) {
+          poly p = *t.l * *t.r;
+          if (t.shift) {
+            p.shift();
+          }
+          ret[k] += std::move(p);
+        }
+      }
+      return ret;
+    }
+
+    static thread_local std::vector<std::vector<modint>> f;
+    if (f.size() < operands.size() + 1) {
+      f.resize(operands.size() + 1);
+    }
+    for (int i = 0; i != operands.size(); i += 1) {
+      const coeffs &c = operands[i]->c;
+      f[i].assign(c.begin(), c.end());
+      f[i].resize(n, modint(0));
+      convolution::forward(f[i].data(), n);
+    }
+    std::vector<modint> &prod = f[operands.size()];
+    prod.resize(n);
+    for (int k = 0, t = 0; k != sums.size(); k += 1) {
+      const auto [low, len] = range[k];
+      if (len == 0) {
+        continue;
+      }
+      coeffs acc(n, modint(0));
+      for (; t != items.size() && items[t][0] == k; t += 1) {
+        const auto [_, a, b, tl] = items[t];
+        for (int i = 0; i != n; i += 1) {
+          prod[i] = f[a][i] * f[b][i];
+        }
+        convolution::shift(prod.data(), n, tl - low);
+        for (int i = 0; i != n; i += 1) {
+          acc[i] += prod[i];
+        }
+      }
+      convolution::inverse(acc.data(), n);
+      acc.resize(len);
+      ret[k] = poly(low, std::move(acc));
+    }
+    return ret;
+  }
+};
+
+struct isets {
+  std::array<std::array<poly, 2>, 2> count;
+
+  isets(int) : count() {
+    count[0][0] = poly(1);
+    count[0][1] = poly(1);
+    count[1][0] = poly(1);
+  }
+
+  static isets compress(isets l, isets r) {
+    std::vector<std::vector<poly::term>> sums;
+    for (int i = 0; i != 2; i += 1) {
+      for (int j = 0; j != 2; j += 1) {
+        sums.push_back({{&l.count[i][1], &r.count[1][j], true},
+                        {&l.count[i][0], &r.count[0][j], false}});
+      }
+    }
+    std::vector<poly> res = poly::sum_of_products(sums);
+    isets ret(0);
+    for (int i = 0; i != 2; i += 1) {
+      for (int j = 0; j != 2; j += 1) {
+        ret.count[i][j] = std::move(res[i * 2 + j]);
+      }
+    }
+    return ret;
+  }
+
+  static isets rake(isets child, isets base) {
+    std::vector<std::vector<poly::term>> sums;
+    for (int i = 0; i != 2; i += 1) {
+      child.count[i][1].shift();
+      child.count[i][1] += std::move(child.count[i][0]);
+      for (int j = 0; j != 2; j += 1) {
+        sums.push_back({{&base.count[i][j], &child.count[i][1], false}});
+      }
+    }
+    std::vector<poly> res = poly::sum_of_products(sums);
+    for (int i = 0; i != 2; i += 1) {
+      for (int j = 0; j != 2; j += 1) {
+        base.count[i][j] = std::move(res[i * 2 + j]);
+      }
+    }
+    return base;
+  }
+
+  void flip() { std::swap(count[0][1], count[1][0]); }
+
+  poly result() {
+    count[0][1].shift();
+    count[1][1].shift();
+    count[1][0].shift();
+    count[1][1].shift();
+    poly ret;
+    ret += std::move(count[0][0]);
+    ret += std::move(count[0][1]);
+    ret += std::move(count[1][0]);
+    ret += std::move(count[1][1]);
+    return ret;
+  }
+};
@@ -0,0 +1,183 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fork-join pool with one deque per thread. Owners push and pop at the back,
+// idle threads steal from the front of other deques. A thread waiting for a
+// task keeps running other tasks, so waiting inside a task never blocks a
+// worker. Workers with nothing to take sleep until a task is pushed. Slot 0 is
+// shared by all threads outside the pool, and a thread should only ever use
+// one pool.
+class task_pool {
+  struct task {
+    std::atomic<bool> done;
+
+    task() : done(false) {}
+    virtual ~task() {}
+    virtual void run() = 0;
+  };
+
+  template <class F> struct task_impl : task {
+    F f;
+    std::optional<std::invoke_result_t<F &>> result;
+
+    task_impl(F f_) : task(), f(std::move(f_)), result() {}
+    void run() override { result.emplace(f()); }
+  };
+
+  struct queue {
+    std::mutex m;
+    std::deque<std::shared_ptr<task>> q;
+  };
+
+  std::vector<queue> queues;
+  std::vector<std::thread> threads;
+  std::atomic<bool> stop;
+
+  // Tasks in the queues and workers asleep on idle_cv. A pusher only locks
+  // idle_m when sleepers is nonzero; both counters are sequentially
+  // consistent so that either the pusher sees the sleeper or the sleeper
+  // sees the task.
+  std::atomic<long> pending;
+  std::atomic<int> sleepers;
+  std::mutex idle_m;
+  std::condition_variable idle_cv;
+
+  static int &slot() {
+    static thread_local int s = 0;
+    return s;
+  }
+
+  std::shared_ptr<task> take(const int i) {
+    {
+      std::lock_guard<std::mutex> lock(queues[i].m);
+      if (!queues[i].q.empty()) {
+        std::shared_ptr<task> t = std::move(queues[i].q.back());
+        queues[i].q.pop_back();
+        pending.fetch_sub(1);
+        return t;
+      }
+    }
+    for (int d = 1; d != queues.size(); d += 1) {
+      queue &v = queues[(i + d) % queues.size()];
+      std::lock_guard<std::mutex> lock(v.m);
+      if (!v.q.empty()) {
+        std::shared_ptr<task> t = std::move(v.q.front());
+        v.q.pop_front();
+        pending.fetch_sub(1);
+        return t;
+      }
+    }
+    return nullptr;
+  }
+
+  bool run_one() {
+    const std::shared_ptr<task> t = take(slot());
+    if (t == nullptr) {
+      return false;
+    }
+    t->run();
+    t->done.store(true, std::memory_order_release);
+    return true;
+  }
+
+  void work(const int i) {
+    slot() = i;
+    while (!stop.load(std::memory_order_acquire)) {
+      if (run_one()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(idle_m);
+      sleepers.fetch_add(1);
+      idle_cv.wait(lock, [this]() {
+        return stop.load(std::memory_order_acquire) || pending.load() > 0;
+      });
+      sleepers.fetch_sub(1);
+    }
+  }
+
+  void wake() {
+    if (sleepers.load() != 0) {
+      std::lock_guard<std::mutex> lock(idle_m);
+      idle_cv.notify_one();
+    }
+  }
+
+public:
+  template <class R> class future {
+    friend task_pool;
+
+    std::shared_ptr<task> t;
+    std::optional<R> *result;
+    std::optional<R> ready;
+
+    future() : t(), result(nullptr), ready() {}
+
+  public:
+    future(R value) : t(), result(nullptr), ready(std::move(value)) {}
+    future(future &&r) = default;
+
+    bool is_ready() const {
+      return t == nullptr || t->done.load(std::memory_order_acquire);
+    }
+
+    // Only after is_ready().
+    R get() { return t == nullptr ? std::move(*ready) : std::move(**result); }
+  };
+
+  // Starts workers threads in addition to the calling ones.
+  task_pool(const unsigned workers)
+      : queues(workers + 1), threads(), stop(false), pending(0), sleepers(0),
+        idle_m(), idle_cv() {
+    for (unsigned i = 0; i != workers; i += 1) {
+      threads.emplace_back([this, i]() { work(i + 1); });
+    }
+  }
+
+  ~task_pool() {
+    stop.store(true, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(idle_m);
+      idle_cv.notify_all();
+    }
+    for (std::thread &t : threads) {
+      t.join();
+    }
+  }
+
+  task_pool(const task_pool &) = delete;
+  task_pool &operator=(const task_pool &) = delete;
+
+  unsigned size() const { return threads.size() + 1; }
+
+  template <class F> auto spawn(F f) -> future<std::invoke_result_t<F &>> {
+    using R = std::invoke_result_t<F &>;
+    auto t = std::make_shared<task_impl<F>>(std::move(f));
+    future<R> ret;
+    ret.result = &t->result;
+    ret.t = t;
+    {
+      queue &q = queues[slot()];
+      std::lock_guard<std::mutex> lock(q.m);
+      q.q.push_back(std::move(t));
+    }
+    pending.fetch_add(1);
+    wake();
+    return ret;
+  }
+
+  template <class R> void wait(const future<R> &f) {
+    while (!f.is_ready()) {
+      if (!run_one()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+};